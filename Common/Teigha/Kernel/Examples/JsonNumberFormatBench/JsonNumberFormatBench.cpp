@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Teigha(R) software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+// JsonNumberFormatBench.cpp : Defines the entry point for the console application.
+//
+/************************************************************************/
+/* This console application checks that OdGLES2JsonNumberFormat writes  */
+/* the same numbers as the printf formats the GLES2 Json server used    */
+/* before ("%f" for |value| in [0.1, 1e16), "%g" otherwise) and compares */
+/* the speed of both.                                                   */
+/*                                                                      */
+/* Calling sequence:                                                    */
+/*                                                                      */
+/*    JsonNumberFormatBench [<floats per precision>]                    */
+/*                                                                      */
+/* Random floats (default 10000000 per precision) are formatted with    */
+/* every precision from 1 to 9 digits; both outputs are parsed back and */
+/* must give the same value. Timing is done with the default precision. */
+/* Returns nonzero if any value differs.                                */
+/************************************************************************/
+#include "OdaCommon.h"
+#include "OdString.h"
+#include "OdPerfTimer.h"
+#include "JsonNumberFormat.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef OD_HAVE_CONSOLE_H_FILE
+#include <console.h>
+#endif
+
+/************************************************************************/
+/* Deterministic float source: coordinates, fractions and any exponent  */
+/************************************************************************/
+class RandomFloats
+{
+  OdUInt64 m_nState;
+
+  OdUInt32 next()
+  {
+    m_nState ^= m_nState << 13;
+    m_nState ^= m_nState >> 7;
+    m_nState ^= m_nState << 17;
+    return OdUInt32(m_nState >> 16);
+  }
+public:
+  RandomFloats() : m_nState(0x2545F4914F6CDD1DULL) { }
+
+  float get()
+  {
+    OdUInt32 nBits = next();
+    switch (nBits & 3)
+    {
+    case 0: // model coordinate
+      return float((double(next()) / 4294967295. - 0.5) * 2e5);
+    case 1: // normal or color component
+      return float(double(next()) / 4294967295. * 2. - 1.);
+    case 2: // exact decimal halves, rounding ties
+      return float(int(next() % 2000001) - 1000000) / 1024.f;
+    default: // any finite float
+      {
+        float val;
+        nBits = next();
+        if (((nBits >> 23) & 0xFF) == 0xFF)
+          nBits &= ~(OdUInt32(1) << 30);
+        ::memcpy(&val, &nBits, sizeof(val));
+        return val;
+      }
+    }
+  }
+};
+
+// Output of the server before OdGLES2JsonNumberFormat
+static int formatPrintf(char *pBuf, float val, int nPrecision)
+{
+  float absVal = (val >= 0.0f) ? val : -val;
+  if (absVal >= 0.1f && absVal < 1e+16)
+    return sprintf(pBuf, "%.*f", nPrecision, (double)val);
+  return sprintf(pBuf, "%.*g", nPrecision, (double)val);
+}
+
+/************************************************************************/
+/* Returns count of values which don't parse to the same double         */
+/************************************************************************/
+static OdUInt64 checkPrecision(int nPrecision, OdUInt32 nFloats)
+{
+  RandomFloats source;
+  char bufPrintf[512], bufFormat[OdGLES2JsonNumberFormat::kMaxFloatChars];
+  OdUInt64 nDiffers = 0;
+  for (OdUInt32 n = 0; n < nFloats; n++)
+  {
+    float val = source.get();
+    formatPrintf(bufPrintf, val, nPrecision);
+    OdGLES2JsonNumberFormat::formatFloat(bufFormat, val, nPrecision, nPrecision);
+    if (strtod(bufPrintf, NULL) != strtod(bufFormat, NULL))
+    {
+      if (nDiffers++ < 10)
+        OdPrintf("  %.9g: printf \"%s\", format \"%s\"\n", (double)val, bufPrintf, bufFormat);
+    }
+  }
+  return nDiffers;
+}
+
+/************************************************************************/
+/* Returns seconds to format nFloats values, nChars takes output length */
+/************************************************************************/
+static double timeFormat(bool bPrintf, int nPrecision, OdUInt32 nFloats, OdUInt64 &nChars)
+{
+  RandomFloats source;
+  char buf[512];
+  OdPerfTimerWrapper timer;
+  nChars = 0;
+  timer.getTimer()->start();
+  for (OdUInt32 n = 0; n < nFloats; n++)
+  {
+    float val = source.get();
+    if (bPrintf)
+      nChars += formatPrintf(buf, val, nPrecision);
+    else
+      nChars += OdGLES2JsonNumberFormat::formatFloat(buf, val, nPrecision, nPrecision) - buf;
+  }
+  timer.getTimer()->stop();
+  return timer.getTimer()->countedSec();
+}
+
+/************************************************************************/
+/* Main                                                                 */
+/************************************************************************/
+#if defined(OD_USE_WMAIN)
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+#ifdef OD_HAVE_CCOMMAND_FUNC
+  argc = ccommand(&argv);
+#endif
+
+  OdUInt32 nFloats = (argc > 1) ? (OdUInt32)atoi(OdString(argv[1])) : 10000000;
+
+  OdUInt64 nDiffers = 0;
+  for (int nPrecision = 1; nPrecision <= OdGLES2JsonNumberFormat::kMaxDecimals; nPrecision++)
+  {
+    OdUInt64 nPrecisionDiffers = checkPrecision(nPrecision, nFloats);
+    OdPrintf("precision %d: %u floats, %u differ\n", nPrecision, (unsigned)nFloats, (unsigned)nPrecisionDiffers);
+    nDiffers += nPrecisionDiffers;
+  }
+
+  OdUInt64 nCharsPrintf, nCharsFormat;
+  double dPrintf = timeFormat(true, 6, nFloats, nCharsPrintf);
+  double dFormat = timeFormat(false, 6, nFloats, nCharsFormat);
+  OdPrintf("printf %10.1f ms %12.0f floats/s %12u bytes\n", dPrintf * 1000., dPrintf > 0. ? nFloats / dPrintf : 0., (unsigned)nCharsPrintf);
+  OdPrintf("format %10.1f ms %12.0f floats/s %12u bytes\n", dFormat * 1000., dFormat > 0. ? nFloats / dFormat : 0., (unsigned)nCharsFormat);
+
+  return nDiffers ? 1 : 0;
+}
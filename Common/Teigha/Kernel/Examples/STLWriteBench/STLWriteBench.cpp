@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Teigha(R) software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+// STLWriteBench.cpp : Defines the entry point for the console application.
+//
+/************************************************************************/
+/* This console application measures binary STL triangle output of the  */
+/* STL export: records packed into blocks by OdSTLBinaryRecordBlock     */
+/* against the per-field stream calls the exporter made before (four    */
+/* 12-byte putBytes and a wrInt16 per triangle).                        */
+/*                                                                      */
+/* Calling sequence:                                                    */
+/*                                                                      */
+/*    STLWriteBench <output file> [<triangles>]                         */
+/*                                                                      */
+/* Random triangles (default 2000000) are written to a memory stream,   */
+/* to a file stream of the system services and to a file descriptor     */
+/* as exportSTLToDescriptor does. The best of three runs is printed for */
+/* each stream. Returns nonzero if both ways don't write the same bytes */
+/************************************************************************/
+#include "OdaCommon.h"
+#include "StaticRxObject.h"
+#include "ExSystemServices.h"
+#include "MemoryStream.h"
+#include "OdPlatformStreamer.h"
+#include "OdPerfTimer.h"
+#include "STLBinaryWriter.h"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef OD_HAVE_CONSOLE_H_FILE
+#include <console.h>
+#endif
+
+using namespace TD_STL_EXPORT;
+
+enum StreamType
+{
+  kMemoryStream,
+  kFileStream,
+  kDescriptorStream
+};
+
+/************************************************************************/
+/* Deterministic model coordinates, twelve floats per triangle          */
+/************************************************************************/
+static void randomTriangles(OdArray<float, OdMemoryAllocator<float> > &coords, OdUInt32 nTriangles)
+{
+  OdUInt64 nState = 0x2545F4914F6CDD1DULL;
+  coords.resize(nTriangles * 12);
+  for (OdUInt32 n = 0; n < coords.size(); n++)
+  {
+    nState ^= nState << 13;
+    nState ^= nState >> 7;
+    nState ^= nState << 17;
+    coords[n] = float((double(OdUInt32(nState >> 16)) / 4294967295. - 0.5) * 2e5);
+  }
+}
+
+static void writeTriangles(OdStreamBuf &stream, const float *pCoords, OdUInt32 nTriangles, bool bBlocks)
+{
+  OdAnsiString header(' ', 80);
+  stream.putBytes(header.c_str(), 80);
+  OdPlatformStreamer::wrInt32(stream, nTriangles);
+  if (bBlocks)
+  {
+    OdSTLBinaryRecordBlock block;
+    block.reset();
+    for (OdUInt32 n = 0; n < nTriangles; n++)
+      block.add(pCoords + n * 12, stream);
+    block.flush(stream);
+  }
+  else
+  {
+    for (OdUInt32 n = 0; n < nTriangles; n++)
+    {
+      const float *pTriangle = pCoords + n * 12;
+      stream.putBytes(pTriangle, 12);
+      stream.putBytes(pTriangle + 3, 12);
+      stream.putBytes(pTriangle + 6, 12);
+      stream.putBytes(pTriangle + 9, 12);
+      OdPlatformStreamer::wrInt16(stream, 0);
+    }
+  }
+}
+
+static int openDescriptor(const OdString &fileName)
+{
+#ifdef _WIN32
+  return _wopen(fileName.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  return ::open((const char*)OdAnsiString(fileName), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#endif
+}
+
+static void closeDescriptor(int fd)
+{
+#ifdef _WIN32
+  _close(fd);
+#else
+  ::close(fd);
+#endif
+}
+
+/************************************************************************/
+/* Returns seconds of the best run, pMemory takes memory stream output  */
+/************************************************************************/
+static double timeWrite(StreamType type, const OdString &fileName, const float *pCoords, OdUInt32 nTriangles,
+                        bool bBlocks, OdStreamBufPtr *pMemory)
+{
+  double dBest = 0.;
+  for (int nRun = 0; nRun < 3; nRun++)
+  {
+    OdPerfTimerWrapper timer;
+    timer.getTimer()->start();
+    if (type == kMemoryStream)
+    {
+      OdStreamBufPtr pStream = OdMemoryStream::createNew();
+      writeTriangles(*pStream, pCoords, nTriangles, bBlocks);
+      *pMemory = pStream;
+    }
+    else if (type == kFileStream)
+    {
+      OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(fileName, Oda::kFileWrite, Oda::kShareDenyNo, Oda::kCreateAlways);
+      writeTriangles(*pStream, pCoords, nTriangles, bBlocks);
+    }
+    else
+    {
+      int fd = openDescriptor(fileName);
+      if (fd < 0)
+        throw OdError(eFileWriteError);
+      OdStaticRxObject<OdSTLDescriptorStream> stream;
+      stream.setDescriptor(fd);
+      try
+      {
+        writeTriangles(stream, pCoords, nTriangles, bBlocks);
+      }
+      catch (...)
+      {
+        closeDescriptor(fd);
+        throw;
+      }
+      closeDescriptor(fd);
+    }
+    timer.getTimer()->stop();
+    double dRun = timer.getTimer()->countedSec();
+    if (!nRun || dRun < dBest)
+      dBest = dRun;
+  }
+  return dBest;
+}
+
+static bool sameBytes(OdStreamBuf &first, OdStreamBuf &second)
+{
+  if (first.length() != second.length())
+    return false;
+  first.rewind();
+  second.rewind();
+  OdUInt8 bufFirst[0x10000], bufSecond[0x10000];
+  for (OdUInt64 nLeft = first.length(); nLeft; )
+  {
+    OdUInt32 nChunk = (OdUInt32)odmin(nLeft, (OdUInt64)sizeof(bufFirst));
+    first.getBytes(bufFirst, nChunk);
+    second.getBytes(bufSecond, nChunk);
+    if (::memcmp(bufFirst, bufSecond, nChunk))
+      return false;
+    nLeft -= nChunk;
+  }
+  return true;
+}
+
+static void printStream(const char *pName, double dFields, double dBlocks, OdUInt32 nTriangles)
+{
+  OdPrintf("%-10s per field %8.2f Mtri/s   blocks %8.2f Mtri/s   x%.2f\n", pName,
+           dFields > 0. ? nTriangles / dFields / 1e6 : 0., dBlocks > 0. ? nTriangles / dBlocks / 1e6 : 0.,
+           dBlocks > 0. ? dFields / dBlocks : 0.);
+}
+
+/************************************************************************/
+/* Main                                                                 */
+/************************************************************************/
+#if defined(OD_USE_WMAIN)
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+#ifdef OD_HAVE_CCOMMAND_FUNC
+  argc = ccommand(&argv);
+#endif
+
+  if (argc < 2)
+  {
+    OdPrintf("usage: STLWriteBench <output file> [<triangles>]\n");
+    return 1;
+  }
+
+  /**********************************************************************/
+  /* Initialize Runtime Extension environment                           */
+  /**********************************************************************/
+  OdStaticRxObject<ExSystemServices> svcs;
+  odrxInitialize(&svcs);
+
+  int nRes = 0;
+  try
+  {
+    OdString fileName(argv[1]);
+    OdUInt32 nTriangles = (argc > 2) ? (OdUInt32)atoi(OdString(argv[2])) : 2000000;
+    OdArray<float, OdMemoryAllocator<float> > coords;
+    randomTriangles(coords, nTriangles);
+    OdPrintf("%u triangles, %u bytes per output\n", (unsigned)nTriangles, (unsigned)(84 + nTriangles * OdSTLBinaryRecordBlock::kRecordSize));
+
+    OdStreamBufPtr pFields, pBlocks;
+    double dFields = timeWrite(kMemoryStream, fileName, coords.getPtr(), nTriangles, false, &pFields);
+    double dBlocks = timeWrite(kMemoryStream, fileName, coords.getPtr(), nTriangles, true, &pBlocks);
+    printStream("memory", dFields, dBlocks, nTriangles);
+    if (!sameBytes(*pFields, *pBlocks))
+    {
+      OdPrintf("Outputs differ!\n");
+      nRes = 1;
+    }
+    pFields.release();
+    pBlocks.release();
+
+    dFields = timeWrite(kFileStream, fileName, coords.getPtr(), nTriangles, false, 0);
+    dBlocks = timeWrite(kFileStream, fileName, coords.getPtr(), nTriangles, true, 0);
+    printStream("file", dFields, dBlocks, nTriangles);
+
+    dFields = timeWrite(kDescriptorStream, fileName, coords.getPtr(), nTriangles, false, 0);
+    dBlocks = timeWrite(kDescriptorStream, fileName, coords.getPtr(), nTriangles, true, 0);
+    printStream("descriptor", dFields, dBlocks, nTriangles);
+  }
+  catch (OdError& e)
+  {
+    OdPrintf("Exception (%ls) during the benchmark!\n", e.description().c_str());
+    nRes = 1;
+  }
+  catch (...)
+  {
+    OdPrintf("Unknown Exception during the benchmark!\n");
+    nRes = 1;
+  }
+
+  /**********************************************************************/
+  /* Uninitialize Runtime Extension environment                         */
+  /**********************************************************************/
+  ::odrxUninitialize();
+
+  return nRes;
+}
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Teigha(R) software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+// ThreadPoolBench.cpp : Defines the entry point for the console application.
+//
+/************************************************************************/
+/* This console application measures how fast the multithreaded queue   */
+/* of the ThreadPool module dispatches many small entries.              */
+/*                                                                      */
+/* Calling sequence:                                                    */
+/*                                                                      */
+/*    ThreadPoolBench [<threads> [<entries> [<spin>]]]                  */
+/*                                                                      */
+/* Every workload queues <entries> entries (default 200000) on a queue  */
+/* of <threads> threads (default - all CPUs):                           */
+/*                                                                      */
+/*    empty     entries do nothing, only the dispatch cost is measured  */
+/*    uniform   every entry spins <spin> iterations (default 2000)      */
+/*    skewed    every 16th entry spins 64 times longer                  */
+/*                                                                      */
+/* The best of three runs is printed for each workload.                 */
+/************************************************************************/
+#include "OdaCommon.h"
+#include "StaticRxObject.h"
+#include "ExSystemServices.h"
+#include "DynamicLinker.h"
+#include "RxDynamicModule.h"
+#include "RxThreadPoolService.h"
+#include "OdModuleNames.h"
+#include "OdPerfTimer.h"
+
+#include <stdlib.h>
+
+#ifdef OD_HAVE_CONSOLE_H_FILE
+#include <console.h>
+#endif
+
+#ifndef _TOOLKIT_IN_DLL_
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRxThreadPoolImpl);
+
+ODRX_BEGIN_STATIC_MODULE_MAP()
+  ODRX_DEFINE_STATIC_APPMODULE(OdThreadPoolModuleName, OdRxThreadPoolImpl)
+ODRX_END_STATIC_MODULE_MAP()
+#endif
+
+/************************************************************************/
+/* Queue entry, spins the number of iterations passed as parameter      */
+/************************************************************************/
+class BenchAtom : public OdApcAtom
+{
+public:
+  OdRefCounter m_nDone;
+  OdUInt32     m_nSink;
+
+  void apcEntryPoint(OdApcParamType nSpin)
+  {
+    OdUInt32 nState = (OdUInt32)nSpin;
+    for (OdApcParamType n = 0; n < nSpin; n++)
+      nState = nState * 1664525u + 1013904223u;
+    m_nSink = nState; // keeps the loop from being optimized out
+    ++m_nDone;
+  }
+};
+
+/************************************************************************/
+/* Returns seconds of the best of three runs                            */
+/************************************************************************/
+static double runWorkload(OdRxThreadPoolService* pTP, int nThreads, OdUInt32 nEntries, OdUInt32 nSpin, OdUInt32 nSkew)
+{
+  OdStaticRxObject<BenchAtom> atom;
+  OdPerfTimerWrapper timer;
+  double dBest = 0.;
+  for (int nRun = 0; nRun < 3; nRun++)
+  {
+    atom.m_nDone = 0;
+    timer.getTimer()->clear();
+    timer.getTimer()->start();
+    OdApcQueuePtr pQueue = pTP->newMTQueue(ThreadsCounter::kNoAttributes, nThreads);
+    for (OdUInt32 nEntry = 0; nEntry < nEntries; nEntry++)
+    {
+      OdUInt32 nEntrySpin = (nSkew && !(nEntry % 16)) ? nSpin * nSkew : nSpin;
+      pQueue->addEntryPoint(&atom, (OdApcParamType)nEntrySpin);
+    }
+    pQueue->wait();
+    timer.getTimer()->stop();
+    if ((int)atom.m_nDone != (int)nEntries)
+    {
+      OdPrintf("Lost entries: %d of %u done\n", (int)atom.m_nDone, nEntries);
+      return -1.;
+    }
+    double dRun = timer.getTimer()->countedSec();
+    if (!nRun || dRun < dBest)
+      dBest = dRun;
+  }
+  return dBest;
+}
+
+static void printWorkload(const char* pName, double dSec, OdUInt32 nEntries)
+{
+  if (dSec < 0.)
+    return;
+  OdPrintf("%-8s %10.1f ms %12.0f entries/s\n", pName, dSec * 1000., dSec > 0. ? nEntries / dSec : 0.);
+}
+
+/************************************************************************/
+/* Main                                                                 */
+/************************************************************************/
+#if defined(OD_USE_WMAIN)
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+#ifdef OD_HAVE_CCOMMAND_FUNC
+  argc = ccommand(&argv);
+#endif
+
+#ifndef _TOOLKIT_IN_DLL_
+  ODRX_INIT_STATIC_MODULE_MAP();
+#endif
+
+  /**********************************************************************/
+  /* Initialize Runtime Extension environment                           */
+  /**********************************************************************/
+  OdStaticRxObject<ExSystemServices> svcs;
+  odrxInitialize(&svcs);
+
+  int nRes = 0;
+  try
+  {
+    OdRxThreadPoolServicePtr pTP = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, false);
+    if (pTP.isNull())
+    {
+      OdPrintf("Can't load ThreadPool module!\n");
+      nRes = 1;
+    }
+    else
+    {
+      int nThreads = (argc > 1) ? atoi(OdString(argv[1])) : 0;
+      if (nThreads <= 0 || nThreads > pTP->numThreads())
+        nThreads = odmin(pTP->numCPUs(), pTP->numThreads());
+      OdUInt32 nEntries = (argc > 2) ? (OdUInt32)atoi(OdString(argv[2])) : 200000;
+      OdUInt32 nSpin = (argc > 3) ? (OdUInt32)atoi(OdString(argv[3])) : 2000;
+
+      OdPrintf("%d threads, %u entries, %u spins per entry\n", nThreads, nEntries, nSpin);
+      printWorkload("empty", runWorkload(pTP, nThreads, nEntries, 0, 0), nEntries);
+      printWorkload("uniform", runWorkload(pTP, nThreads, nEntries, nSpin, 0), nEntries);
+      printWorkload("skewed", runWorkload(pTP, nThreads, nEntries, nSpin, 64), nEntries);
+    }
+  }
+  catch (OdError& e)
+  {
+    OdPrintf("Exception (%ls) during the benchmark!\n", e.description().c_str());
+    nRes = 1;
+  }
+  catch (...)
+  {
+    OdPrintf("Unknown Exception during the benchmark!\n");
+    nRes = 1;
+  }
+
+  /**********************************************************************/
+  /* Uninitialize Runtime Extension environment                         */
+  /**********************************************************************/
+  ::odrxUninitialize();
+
+  return nRes;
+}
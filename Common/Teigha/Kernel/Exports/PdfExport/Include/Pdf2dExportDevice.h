@@ -45,6 +45,8 @@
 #include "PdfExportService.h"
 #include "PdfAnnotationDictionary.h"
 #include "Pdf2PrcExportParams.h"
+#define STL_USING_SET
+#include "OdaSTL.h"
 
 //////////////////////////////////////////////////////////////////////
 using namespace TD_2D_EXPORT;
@@ -65,6 +67,29 @@ struct PDFDevicePoint {
   double y; // Y coordinate of the device point
 };
 
+/** \details
+  This structure implements the device segment, used to detect segments repeated within one path.
+*/
+struct PDFDeviceSegment {
+  PDFDevicePoint p0; // lesser end point of the segment
+  PDFDevicePoint p1; // greater end point of the segment
+
+  PDFDeviceSegment(const PDFDevicePoint &a, const PDFDevicePoint &b)
+  {
+    bool bSwap = (b.x < a.x) || (b.x == a.x && b.y < a.y);
+    p0 = bSwap ? b : a;
+    p1 = bSwap ? a : b;
+  }
+
+  bool operator < (const PDFDeviceSegment &seg) const
+  {
+    if (p0.x != seg.p0.x) return p0.x < seg.p0.x;
+    if (p0.y != seg.p0.y) return p0.y < seg.p0.y;
+    if (p1.x != seg.p1.x) return p1.x < seg.p1.x;
+    return p1.y < seg.p1.y;
+  }
+};
+
 struct ViewExtents {
   int m_viewIdx;
   OdGeExtents3d m_extents;
@@ -148,6 +173,10 @@ private:
   OdUInt32          m_num; // Points count.
   PDFDevicePoint    m_points[6]; // Static array of the points which the polygon consists of
 
+  bool              m_bPathPending; // Shows if the path has subpaths which aren't stroked yet.
+  OdUInt32          m_nPendingSubpaths; // Number of subpaths in the pending path.
+  std::set<PDFDeviceSegment> m_PendingSegments; // Separate segments of the pending path.
+
   PDFNamePtr        DWG_PALETTE_NAME; // Name of the pallete currently used by the export device.
   PDFNamePtr        PDF_OC_NAME; // Name of the PDF document used by the export device.
   bool              m_bDwgPaletteNeeded;//shows if indexed dwg palette is necessary
@@ -231,6 +260,21 @@ protected:
   */
   void saveLastPoint(const PDFDevicePoint& LastPoint);
 
+  /** \details
+    Finishes the current polyline as a subpath of the pending path without stroking it,
+    so subsequent polylines with the same graphic state are stroked together.
+  */
+  void EndSubpath();
+
+  /** \details
+    Returns true if the segment was already added to the pending path as a separate polyline,
+    otherwise remembers it and returns false.
+
+    \param p0 [in]  Start point of the segment.
+    \param p1 [in]  End point of the segment.
+  */
+  bool isPendingSegment(const PDFDevicePoint &p0, const PDFDevicePoint &p1);
+
   /** \details
   Converts color to grayscale.
 
@@ -109,6 +109,23 @@ public:
  Implements the smart pointer to the PDF export module.
 */
 typedef OdSmartPtr<PdfExportModule> OdPdfExportModulePtr;
+
+/** \details
+  Sets the file used to persist the SHX glyph geometry cache between processes.
+
+  \param fileName [in]  Full path of the cache file.
+
+  \remarks
+  SHX glyph geometry is always cached in memory for the lifetime of the process.
+  The glyphs of the file are merged into the cache when it is set; new glyphs are written back
+  once, when the PDF export module is unloaded. Empty string (default) disables persistence.
+*/
+PDFEXPORT_DLL void setShxGlyphCacheFile(const OdString &fileName);
+
+/** \details
+  Returns the file used to persist the SHX glyph geometry cache.
+*/
+PDFEXPORT_DLL OdString shxGlyphCacheFile();
 }
 #endif // _PDF_EXPORT_INCLUDED_
 
@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _PDF_RASTERIMAGEWINDOW_
+#define _PDF_RASTERIMAGEWINDOW_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "Gi/GiRasterImage.h"
+#include "UInt8Array.h"
+#include "UInt32Array.h"
+
+namespace TD_PDF_2D_EXPORT {
+
+/** \details
+  This class implements a lazy window onto a raster image for PDF export.
+
+  \remarks
+  The window crops a rectangle of the original image and optionally downsamples it.
+  Scanlines are produced on request from the corresponding scanlines of the original,
+  so neither the cropped nor the downsampled image is ever held in memory as a whole.
+  Direct color images of 8 bits per pixel and more are downsampled with a box filter,
+  palette and low bit depth images are downsampled by the nearest pixel.
+*/
+class PDFRasterImageWindow : public OdGiRasterImage
+{
+public:
+  PDFRasterImageWindow();
+
+  /** \details
+    Creates the window onto pOrig.
+
+    \param pOrig [in]  Original raster image.
+    \param x [in]  Left column of the window in the original image.
+    \param y [in]  First scanline of the window in the original image.
+    \param srcWidth [in]  Window width in pixels of the original image.
+    \param srcHeight [in]  Window height in pixels of the original image.
+    \param width [in]  Width of the resulting image.
+    \param height [in]  Height of the resulting image.
+
+    \remarks
+    The window is clamped by the original image.
+  */
+  static OdGiRasterImagePtr createObject(const OdGiRasterImage* pOrig, OdUInt32 x, OdUInt32 y, OdUInt32 srcWidth, OdUInt32 srcHeight,
+                                         OdUInt32 width, OdUInt32 height);
+
+  virtual OdUInt32 pixelWidth() const { return m_width; }
+  virtual OdUInt32 pixelHeight() const { return m_height; }
+  virtual OdUInt32 colorDepth() const { return m_pImage->colorDepth(); }
+  virtual OdUInt32 numColors() const { return m_pImage->numColors(); }
+  virtual ODCOLORREF color(OdUInt32 colorIndex) const { return m_pImage->color(colorIndex); }
+  virtual OdUInt32 paletteDataSize() const { return m_pImage->paletteDataSize(); }
+  virtual void paletteData(OdUInt8* bytes) const { m_pImage->paletteData(bytes); }
+  virtual PixelFormatInfo pixelFormat() const { return m_pImage->pixelFormat(); }
+  virtual Units defaultResolution(double& xPelsPerUnit, double& yPelsPerUnit) const { return m_pImage->defaultResolution(xPelsPerUnit, yPelsPerUnit); }
+  virtual int transparentColor() const { return m_pImage->transparentColor(); }
+  virtual ImageSource imageSource() const { return m_pImage->imageSource(); }
+  virtual const OdString &sourceFileName() const { return m_pImage->sourceFileName(); }
+  virtual TransparencyMode transparencyMode() const { return m_pImage->transparencyMode(); }
+  virtual OdUInt32 scanLinesAlignment() const { return m_pImage->scanLinesAlignment(); }
+  virtual OdUInt32 scanLineSize() const;
+
+  // there is no contiguous scanlines buffer, they are produced on request
+  virtual const OdUInt8* scanLines() const { return 0; }
+  virtual void scanLines(OdUInt8* pBytes, OdUInt32 index, OdUInt32 numLines = 1) const;
+
+private:
+  const OdUInt8 *sourceLine(OdUInt32 index) const;
+  void copyLine(OdUInt8 *pDst, const OdUInt8 *pSrc) const;
+  void averageLines(OdUInt8 *pDst, OdUInt32 firstLine, OdUInt32 numLines) const;
+
+  OdGiRasterImagePtr m_pImage;
+  OdUInt32 m_x, m_y;                  // window origin in the original image
+  OdUInt32 m_srcWidth, m_srcHeight;   // window size in the original image
+  OdUInt32 m_width, m_height;         // size of the resulting image
+  mutable OdUInt8Array  m_SrcLine;    // scanline of the original image
+  mutable OdUInt32Array m_Sums;       // per channel sums of the box filter
+};
+
+}
+#endif // #ifndef _PDF_RASTERIMAGEWINDOW_
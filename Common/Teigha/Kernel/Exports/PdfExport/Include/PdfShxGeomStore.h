@@ -38,6 +38,7 @@
 #include "Gi/GiEmptyGeometry.h"
 #include "Ge/GePoint3dArray.h"
 #include "Ge/GeCircArc3d.h"
+#include "Ge/GePoint2dArray.h"
 
 #include "PdfIContentCommands4Type3.h"
 #include "PdfIContentCommands.h"
@@ -125,6 +126,35 @@ public:
 
 //////////////////////////////////////////////////////////////////////
 
+/** \details
+  This structure holds the geometry of a single SHX glyph in font units,
+  as it was recorded by PDFShxGeomStore.
+*/
+struct PDFShxGlyphGeom
+{
+  OdArray<OdGePoint3dArray> m_Lines;
+  OdArray<OdGeCircArc3d>    m_Circles;
+  OdArray<OdGePoint2dArray> m_OuterContours;
+  OdArray<OdGePoint2dArray> m_InnerContours;
+  OdGePoint2d               m_adv;
+
+  /** \details
+    Returns the approximate number of bytes occupied by the glyph geometry.
+  */
+  OdUInt32 memoryUsage() const
+  {
+    OdUInt32 nBytes = sizeof(PDFShxGlyphGeom) + m_Circles.size() * sizeof(OdGeCircArc3d);
+    OdUInt32 f;
+    for (f = 0; f < m_Lines.size(); ++f)
+      nBytes += sizeof(OdGePoint3dArray) + m_Lines[f].size() * sizeof(OdGePoint3d);
+    for (f = 0; f < m_OuterContours.size(); ++f)
+      nBytes += sizeof(OdGePoint2dArray) + m_OuterContours[f].size() * sizeof(OdGePoint2d);
+    for (f = 0; f < m_InnerContours.size(); ++f)
+      nBytes += sizeof(OdGePoint2dArray) + m_InnerContours[f].size() * sizeof(OdGePoint2d);
+    return nBytes;
+  }
+};
+
 /** \details
   This class implements the PDF SHX geometry store for PDF export.
 */
@@ -156,6 +186,17 @@ public:
   virtual void setScale(double dGeomScale);
   virtual double getScale() const;
 
+  /** \details
+    Copies the recorded glyph geometry and advance into geom.
+  */
+  void getGeometry(PDFShxGlyphGeom &geom) const;
+
+  /** \details
+    Replaces the recorded glyph geometry and advance with geom,
+    so a previously recorded glyph can be emitted without drawing the character again.
+  */
+  void setGeometry(const PDFShxGlyphGeom &geom);
+
   virtual void polylineProc(
     OdInt32 numPoints, const OdGePoint3d* vertexList,
     const OdGeVector3d* pNormal = 0,
@@ -0,0 +1,163 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _PDF_SHXGLYPHCACHE_
+#define _PDF_SHXGLYPHCACHE_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "PdfShxGeomStore.h"
+#include "OdMutex.h"
+#define STL_USING_MAP
+#define STL_USING_LIST
+#include "OdaSTL.h"
+
+namespace TD_PDF_2D_EXPORT {
+
+/** \details
+  This class implements the process-wide cache of SHX glyph geometry for PDF export.
+
+  \remarks
+  Glyphs are stored in font units, so one entry serves every text height; the scale is
+  applied when the glyph is emitted. The cache is shared by all exports of the process,
+  is guarded by a mutex and evicts the least recently used glyphs once its memory limit is exceeded.
+*/
+class PDFShxGlyphCache
+{
+public:
+  enum GlyphFlags
+  {
+    kBigFont  = 1, // glyph is drawn with the big font of the text style
+    kVertical = 2  // glyph is drawn as vertical text
+  };
+
+  PDFShxGlyphCache();
+
+  /** \details
+    Returns the cache instance shared by the process.
+  */
+  static PDFShxGlyphCache &instance();
+
+  /** \details
+    Looks up the glyph of character ch drawn by the font file fontFile with GlyphFlags flags.
+    Returns true and fills geom if the glyph is cached.
+  */
+  bool find(const OdString &fontFile, OdChar ch, OdUInt32 flags, PDFShxGlyphGeom &geom);
+
+  /** \details
+    Stores the glyph of character ch drawn by the font file fontFile with GlyphFlags flags.
+  */
+  void add(const OdString &fontFile, OdChar ch, OdUInt32 flags, const PDFShxGlyphGeom &geom);
+
+  /** \details
+    Sets the memory limit of the cache in bytes; 0 disables caching.
+  */
+  void setMemoryLimit(OdUInt32 nBytes);
+  OdUInt32 memoryLimit() const;
+
+  /** \details
+    Removes all glyphs from the cache.
+  */
+  void clear();
+
+  /** \details
+    Sets the file which persists the cache between processes and merges its glyphs into the cache.
+    Unsaved glyphs are written to the previous file first; a missing or damaged file is ignored.
+    Glyphs of font files whose size or modification time changed since they were saved are skipped.
+    Empty string (default) disables persistence.
+  */
+  void setFile(const OdString &fileName);
+  OdString file() const;
+
+  /** \details
+    Writes all cached glyphs to the file if the cache changed since it was loaded or saved.
+    Called once when the PDF export module is unloaded.
+  */
+  bool save();
+
+private:
+  struct GlyphKey
+  {
+    OdString m_FontFile;
+    OdChar   m_ch;
+    OdUInt32 m_flags;
+
+    bool operator < (const GlyphKey &key) const
+    {
+      if (m_ch != key.m_ch)
+        return m_ch < key.m_ch;
+      if (m_flags != key.m_flags)
+        return m_flags < key.m_flags;
+      return m_FontFile < key.m_FontFile;
+    }
+  };
+
+  typedef std::list<GlyphKey> GlyphLruList;
+
+  struct GlyphEntry
+  {
+    PDFShxGlyphGeom        m_Geom;
+    OdUInt32               m_nBytes;
+    GlyphLruList::iterator m_Lru;
+  };
+
+  typedef std::map<GlyphKey, GlyphEntry> GlyphMap;
+
+  // identifies the font file contents the glyphs were made from
+  struct FontStamp
+  {
+    OdInt64 m_nSize;
+    OdInt64 m_nMTime;
+
+    bool operator == (const FontStamp &stamp) const
+    {
+      return m_nSize == stamp.m_nSize && m_nMTime == stamp.m_nMTime;
+    }
+  };
+
+  typedef std::map<OdString, FontStamp> FontStampMap;
+
+  void addEntry(const GlyphKey &key, const PDFShxGlyphGeom &geom);
+  static bool getFontStamp(const OdString &fontFile, FontStamp &stamp);
+  void evict();
+  void load();
+
+  mutable OdMutex m_Mutex;
+  GlyphMap        m_Glyphs;
+  FontStampMap    m_FontStamps; // stamp of each font file when its first glyph was cached
+  GlyphLruList    m_Lru;        // most recently used first
+  OdUInt32        m_nMemoryUsed;
+  OdUInt32        m_nMemoryLimit;
+  bool            m_bModified;  // there are glyphs which aren't saved yet
+  OdString        m_FileName;
+};
+
+}
+#endif // #ifndef _PDF_SHXGLYPHCACHE_
@@ -42,6 +42,8 @@
 #include "Int32Array.h"
 #include "PdfShxGeomStore.h"
 #include "BoolArray.h"
+#define STL_USING_MAP
+#include "OdaSTL.h"
 
 using namespace TD_PDF;
 class OdGiTextStyle;
@@ -69,6 +71,7 @@ protected:
     OdUInt16Array   UnicodeChars;
     OdArray<PDFContentStream4Type3Ptr> ContStreams;
     PDFBBoxStore m_BBox;
+    std::map<OdChar, OdUInt8> CharCodes; // Unicode character -> single byte code, mirrors UnicodeChars
 
     const static OdUInt32 nMaxCharactersInType3Font;
 
@@ -80,17 +83,17 @@ protected:
         UnicodeChars.push_back(nch);
         ContStreams.push_back(pGeomData);
         singleByteCode = OdUInt8(UnicodeChars.size() - 1);
+        CharCodes[nch] = singleByteCode;
         return true;
       }
       return false;
     }
 
-    bool hasCharacter(OdChar nch, OdUInt8 &singleByteCode)
+    bool hasCharacter(OdChar nch, OdUInt8 &singleByteCode) const
     {
-      OdUInt16Array::size_type index;
-      
-      bool b = UnicodeChars.find(nch, index);
-      singleByteCode = OdUInt8(b ? index : 0);
+      std::map<OdChar, OdUInt8>::const_iterator it = CharCodes.find(nch);
+      bool b = (it != CharCodes.end());
+      singleByteCode = b ? it->second : OdUInt8(0);
       
       return b;
     }
@@ -108,6 +111,7 @@ protected:
 
 private:
   PDFType3OptElemArray m_pFonts;
+  std::map<const PDFType3Font*, OdUInt32> m_FontIndex; // font -> index in m_pFonts
 
 public:
   PDFType3Optimizer();
@@ -48,6 +48,7 @@
 #include "Gi/GiRasterWrappers.h"
 
 #include "DynamicLinker.h"
+#include "PdfRasterImageWindow.h"
 
 //////////////////////////////////////////////////////////////////////////////////
 // PDF2dExportDevice
@@ -59,6 +60,8 @@ namespace TD_PDF_2D_EXPORT {
     , m_bGraphStateFixed(false)
     , m_bOnePointPoly(false)
     , m_num(0)
+    , m_bPathPending(false)
+    , m_nPendingSubpaths(0)
     , m_LayerOpen(false)
     , m_lineWeight(-HUGE_VAL)
     , m_CapStyle(TD_PDF::kLineCapNotSet)
@@ -93,6 +96,9 @@ PDFDummyContentStream PDF2dExportDevice::m_DummyCCStream = PDFDummyContentStream
 
 void PDF2dExportDevice::enableRecording(bool bEnable /* = true */, bool bZ2E /* = true */)
 {
+  if (m_bPathPending) // stroke it in the stream it belongs to
+    GraphStateChanged();
+
   m_bRecordingEnabled = bEnable;
   if (bEnable)
   {
@@ -539,6 +545,9 @@ void PDF2dExportDevice::onTraitsModified(const OdGiSubEntityTraitsData& currTrai
   Od2dExportDevice::onTraitsModified(currTraits);
 }
 
+// Non-bitonal images with more scanline data are downsampled by PDFRasterImageWindow instead of raster services
+static const OdUInt64 kMaxRescaledInMemory = 64 * 1024 * 1024;
+
 class PdfBug16745Wrap : public OdGiRasterImage
 {
 public:
@@ -638,11 +647,23 @@ void PDF2dExportDevice::rasterImageProc(const OdGePoint3d& origin,
       maximum that it can be, so - here is no point to increase it)*/
     {
       double iScale = (double)necessary_dpi / (double)current_dpi;
+      OdUInt32 newPixelWidth = (OdUInt32)((double)pImg->pixelWidth()*iScale);
+      OdUInt32 newPixelHeight = (OdUInt32)((double)pImg->pixelHeight()*iScale);
+
+      // huge images are downsampled on the fly while their scanlines are written,
+      // the BMP round trip below would hold both the original and the rescaled copy in memory.
+      // Bitonal images keep the round trip, the window can't apply Floyd-Steinberg dithering.
+      if (pImg->numColors() != 2 && OdUInt64(pImg->scanLineSize()) * pImg->pixelHeight() > kMaxRescaledInMemory && newPixelWidth && newPixelHeight)
+      {
+        OdGiRasterImagePtr pImage = PDFRasterImageWindow::createObject(pImg, 0, 0, pImg->pixelWidth(), pImg->pixelHeight(), newPixelWidth, newPixelHeight);
+        dc_raster_image(origin, u / iScale, v / iScale, pImage, pUVBound, numBoundPts, transparency, brightness, contrast, fade, entityColor);
+        return;
+      }
 
       OdRxRasterServicesPtr pRasSvcs = odrxDynamicLinker()->loadApp(RX_RASTER_SERVICES_APPNAME);
       OdMemoryStreamPtr pStm = OdMemoryStream::createNew();
-      OdUInt32 flags[9] = { OdRxRasterServices::kRescale, OdRxRasterServices::kRescaleBox, OdRxRasterServices::kRescaleWidth,(OdUInt32)((double)pImg->pixelWidth()*iScale),
-        OdRxRasterServices::kRescaleHeight, (OdUInt32)((double)pImg->pixelHeight()*iScale), 0, 0, 0 };
+      OdUInt32 flags[9] = { OdRxRasterServices::kRescale, OdRxRasterServices::kRescaleBox, OdRxRasterServices::kRescaleWidth, newPixelWidth,
+        OdRxRasterServices::kRescaleHeight, newPixelHeight, 0, 0, 0 };
       if (pImg->numColors() == 2)
       {
         flags[6] = OdRxRasterServices::kDithering;
@@ -69,42 +69,39 @@ namespace TD_PDF_2D_EXPORT {
     virtual qpdf_offset_t findAndSkipNextEOL()
     {
       qpdf_offset_t result = 0;
-      bool done = false;
+      bool bFound = false;
       char buf[10240];
-      while (!done)
+      for (;;)
       {
         qpdf_offset_t cur_offset = tell();
         size_t len = read(buf, sizeof(buf));
         if (len == 0)
         {
-          done = true;
-          result = tell();
+          if (!bFound)
+            result = tell();
+          break;
         }
-        else
+        const char* p = buf;
+        const char* pEnd = buf + len;
+        if (!bFound)
         {
           char* p1 = static_cast<char*>(memchr(buf, '\r', len));
           char* p2 = static_cast<char*>(memchr(buf, '\n', len));
-          char* p = (p1 && p2) ? std::min(p1, p2) : p1 ? p1 : p2;
-          if (p)
-          {
-            result = cur_offset + (p - buf);
-            // We found \r or \n.  Keep reading until we get past
-            // \r and \n characters.
-            seek(result + 1, SEEK_SET);
-            char ch;
-            while (!done)
-            {
-              if (read(&ch, 1) == 0)
-              {
-                done = true;
-              }
-              else if (!((ch == '\r') || (ch == '\n')))
-              {
-                unreadCh(ch);
-                done = true;
-              }
-            }
-          }
+          p = (p1 && p2) ? std::min(p1, p2) : p1 ? p1 : p2;
+          if (!p)
+            continue;
+          // We found \r or \n.
+          result = cur_offset + (p - buf);
+          bFound = true;
+        }
+        // Skip the \r and \n run inside the buffer already read instead of
+        // seeking back and reading it byte by byte.
+        while (p < pEnd && (*p == '\r' || *p == '\n'))
+          ++p;
+        if (p < pEnd)
+        {
+          seek(cur_offset + (p - buf), SEEK_SET);
+          break;
         }
       }
       return result;
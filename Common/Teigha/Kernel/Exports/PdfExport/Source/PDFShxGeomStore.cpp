@@ -61,6 +61,24 @@ double PDFShxGeomStore::getCharWidth() const
   return m_adv.x * m_dGeomScale;
 }
 
+void PDFShxGeomStore::getGeometry(PDFShxGlyphGeom &geom) const
+{
+  geom.m_Lines = m_Lines;
+  geom.m_Circles = m_Circles;
+  geom.m_OuterContours = m_OuterContours;
+  geom.m_InnerContours = m_InnerContours;
+  geom.m_adv = m_adv;
+}
+
+void PDFShxGeomStore::setGeometry(const PDFShxGlyphGeom &geom)
+{
+  m_Lines = geom.m_Lines;
+  m_Circles = geom.m_Circles;
+  m_OuterContours = geom.m_OuterContours;
+  m_InnerContours = geom.m_InnerContours;
+  m_adv = geom.m_adv;
+}
+
 void PDFShxGeomStore::polylineProc(
     OdInt32 numPoints, const OdGePoint3d* vertexList,
     const OdGeVector3d* /*pNormal*/,
@@ -31,6 +31,7 @@
 
 #include "PdfExportCommon.h"
 #include "PdfType3Optimizer.h"
+#include "PdfShxGlyphCache.h"
 #include "PdfContentStream4Type3.h"
 #include "PdfCharProcDictionary.h"
 #include "PdfEncodingDictionary.h"
@@ -56,25 +57,21 @@ PDFType3Optimizer::PDFType3Optimizer()
 void PDFType3Optimizer::clear()
 {
   m_pFonts.clear();
+  m_FontIndex.clear();
 }
 
 PDFType3Optimizer::PDFType3OptElem *PDFType3Optimizer::Find(PDFType3FontPtr pFont)
 {
-  PDFType3OptElemArray::iterator pIt = m_pFonts.begin();
-  PDFType3OptElemArray::iterator pE  = m_pFonts.end();
-
-  while(pIt != pE)
-  {
-    if (pIt->pFont == pFont)
-      return pIt;
-    ++pIt;
-  }
+  std::map<const PDFType3Font*, OdUInt32>::const_iterator it = m_FontIndex.find(pFont.get());
+  if (it == m_FontIndex.end())
+    return 0;
 
-  return 0;
+  return m_pFonts.begin() + it->second;
 }
 
 PDFType3Optimizer::PDFType3OptElem *PDFType3Optimizer::AddNewElem(PDFType3FontPtr pFont)
 {
+  m_FontIndex[pFont.get()] = m_pFonts.size();
   PDFType3OptElem *pElem = m_pFonts.append();
   pElem->pFont = pFont;
   
@@ -120,18 +117,30 @@ void PDFType3Optimizer::addUnicodeChar(const OdGiTextStyle& pTextStyle, PDFType3
       textFlags.setTrackingPercent(1.);
       textFlags.setIncludePenups(false);
 
-      if (isInBigFont)
+      ODA_ASSERT(!isInBigFont || pBigFont);
+      OdFont *pDrawFont = isInBigFont ? pBigFont : pOdFont;
+      ShxGeom.setScale( isInBigFont ? dBigFontScale : 1. );
+
+      // glyph geometry doesn't depend on the document, reuse it if the same glyph was already drawn in this process
+      PDFShxGlyphCache &glyphCache = PDFShxGlyphCache::instance();
+      OdString fontFile = pDrawFont->getFileName();
+      OdUInt32 nGlyphFlags = (isInBigFont ? PDFShxGlyphCache::kBigFont : 0) | (pTextStyle.isVertical() ? PDFShxGlyphCache::kVertical : 0);
+      PDFShxGlyphGeom glyphGeom;
+      if (!fontFile.isEmpty() && glyphCache.find(fontFile, pUnicode, nGlyphFlags, glyphGeom))
       {
-        ODA_ASSERT(pBigFont);
-        ODA_VERIFY(pBigFont->drawCharacter(pUnicode, adv, &ShxGeom, textFlags) == ::eOk);
-        ShxGeom.setScale( dBigFontScale );
+        ShxGeom.setGeometry(glyphGeom);
       }
       else
       {
-        ODA_VERIFY(pOdFont->drawCharacter(pUnicode, adv, &ShxGeom, textFlags) == ::eOk);
-        ShxGeom.setScale( 1. );
+        OdResult res = pDrawFont->drawCharacter(pUnicode, adv, &ShxGeom, textFlags);
+        ODA_ASSERT(res == ::eOk);
+        ShxGeom.setAdvance(adv);
+        if (res == ::eOk && !fontFile.isEmpty())
+        {
+          ShxGeom.getGeometry(glyphGeom);
+          glyphCache.add(fontFile, pUnicode, nGlyphFlags, glyphGeom);
+        }
       }
-      ShxGeom.setAdvance(adv);
       ShxGeom.fillContent(pFont->getLineWeigth());
 
       PDFBBoxStore BBox;
@@ -37,6 +37,7 @@
 #include "PdfImage.h"
 #include "PdfAux.h"
 #include "PdfExportService.h"
+#include "PdfRasterImageWindow.h"
 
 #include "PdfOptionalContentGroupDictionary.h"
 #include "PdfCatalogDictionary.h"
@@ -163,7 +164,10 @@ void PDF2dExportDevice::saveLastPoint(const PDFDevicePoint &LastPoint)
   m_LastPoint.y = LastPoint.y;
 }
 
-void PDF2dExportDevice::GraphStateChanged()
+// Upper limit of subpaths stroked by one operator, keeps the paths reasonable for viewers
+static const OdUInt32 kMaxPendingSubpaths = 4096;
+
+void PDF2dExportDevice::EndSubpath()
 {
   if (m_bGraphStateFixed)
   {
@@ -193,7 +197,8 @@ void PDF2dExportDevice::GraphStateChanged()
         if (h != 0 && w != 0)
         {
           pOut->re(odmin(X0, X2), odmin(Y0, Y2), w, h);
-          pOut->S();
+          m_bPathPending = true;
+          ++m_nPendingSubpaths;
 
           m_bOnePointPoly = true;
           m_bGraphStateFixed = false;
@@ -208,7 +213,6 @@ void PDF2dExportDevice::GraphStateChanged()
     if (m_bOnePointPoly)
     {
       PDFIContentCommands::drawPoint(*pOut, OdGePoint2d(m_LastPoint.x, m_LastPoint.y));
-      pOut->S();
     } 
     else
     {
@@ -227,7 +231,7 @@ void PDF2dExportDevice::GraphStateChanged()
 
       if (m_points[0].x == m_LastPoint.x && m_points[0].y == m_LastPoint.y)
       {
-        pOut->s(); // h & S 
+        pOut->h();
       }
       else
       {
@@ -235,9 +239,10 @@ void PDF2dExportDevice::GraphStateChanged()
           pOut->l(m_points[m_num - 1].x, m_points[m_num - 1].y);
         else
           pOut->l(m_points[m_num - 2].x, m_points[m_num - 2].y);
-        pOut->S();
       }
     }
+    m_bPathPending = true;
+    ++m_nPendingSubpaths;
 
     m_bOnePointPoly = true;
     m_bGraphStateFixed = false;
@@ -246,6 +251,24 @@ void PDF2dExportDevice::GraphStateChanged()
   }
 }
 
+void PDF2dExportDevice::GraphStateChanged()
+{
+  EndSubpath();
+
+  if (m_bPathPending)
+  {
+    cc()->S();
+    m_bPathPending = false;
+    m_nPendingSubpaths = 0;
+    m_PendingSegments.clear();
+  }
+}
+
+bool PDF2dExportDevice::isPendingSegment(const PDFDevicePoint &p0, const PDFDevicePoint &p1)
+{
+  return !m_PendingSegments.insert(PDFDeviceSegment(p0, p1)).second;
+}
+
 bool PDF2dExportDevice::needNewPolyline() const
 {
   return !m_bGraphStateFixed;
@@ -340,6 +363,8 @@ void PDF2dExportDevice::OpenLayerBracket(const OdString &layer_name)
   if (pOCG.isNull())
     pOCG = CreateOC4Layer(layer_name);
 
+  // pending path must be stroked inside the bracket it was drawn in
+  GraphStateChanged();
   pOut->BDC(PDF_OC_NAME, pOCG);
   m_LayerOpen = true;
 }
@@ -348,6 +373,7 @@ void PDF2dExportDevice::CloseLayerBracket()
 {
   ODA_ASSERT(isLayersSupported());
 
+  GraphStateChanged();
   PDFIContentCommands *pOut = cc();
   pOut->EMC(); 
   m_LayerOpen = false;
@@ -358,10 +384,12 @@ void PDF2dExportDevice::open_Frozen_Layer(const OdString &layer_name)
 {
   ODA_ASSERT(isLayersSupported());
 
+  // EndSubpath() defers 'S', flush it before the bracket
+  GraphStateChanged();
+
   // close "general" layer before
   if (m_LayerOpen)
   {
-    GraphStateChanged();
     CloseLayerBracket();
     m_curLayerName = "";
   }
@@ -378,9 +406,10 @@ void PDF2dExportDevice::open_Frozen_Layer(const OdString &layer_name)
 
 void PDF2dExportDevice::close_Frozen_Layer()
 {
+  GraphStateChanged();
+
   if (m_LayerOpen)
   {
-    GraphStateChanged();
     CloseLayerBracket();
     m_curLayerName = "";
   }
@@ -402,9 +431,22 @@ void PDF2dExportDevice::dc_polyline(OdUInt32 nPts, const OdGePoint2d* pPoints)
     tmp.x = (int)(pPoints[0].x);
     tmp.y = (int)(pPoints[0].y);
 
+    // hatch and linetype patterns often repeat the same separate segment, it is already in the path
+    if (nPts == 2)
+    {
+      PDFDevicePoint tmpEnd;
+      tmpEnd.x = (int)(pPoints[1].x);
+      tmpEnd.y = (int)(pPoints[1].y);
+      if ((tmp.x != tmpEnd.x || tmp.y != tmpEnd.y) && isPendingSegment(tmp, tmpEnd))
+        return;
+    }
+
     if (!needNewPolyline() && !isDublicatedSegment(tmp))
     {
-      ClosePolyline();
+      // polylines with the same graphic state are stroked together
+      EndSubpath();
+      if (m_nPendingSubpaths >= kMaxPendingSubpaths)
+        GraphStateChanged();
     }
 
     if (needNewPolyline())
@@ -1069,7 +1111,8 @@ OdGiRasterImagePtr PDF2dExportDevice::cropImage(const OdGiRasterImage* pImg, con
       newPixelHeight++;
     }
 
-    pImgClipped = pImg->crop(cropX, cropY, newPixelWidth, newPixelHeight);
+    // the window reads scanlines of the original on request, the cropped part is never copied as a whole
+    pImgClipped = PDFRasterImageWindow::createObject(pImg, OdUInt32(cropX), OdUInt32(cropY), newPixelWidth, newPixelHeight, newPixelWidth, newPixelHeight);
     origin = newOrigin;
   }
   else
@@ -1467,6 +1510,8 @@ void PDF2dExportDevice::dc_drawtext(const OdAnsiString &fontName, const OdGePoin
 
 void PDF2dExportDevice::dc_pushClip(int nrcContours, const int* nrcCounts, const OdGsDCPointArray &nrcPoints)
 {
+  GraphStateChanged();
+
   PDFIContentCommands *pOut = cc();
 
   pOut->q(); // push graph state to stack
@@ -1487,6 +1532,8 @@ void PDF2dExportDevice::dc_pushClip(int nrcContours, const int* nrcCounts, const
 
 void PDF2dExportDevice::dc_popClip()
 {
+  GraphStateChanged();
+
   PDFIContentCommands *pOut = cc();
   pOut->Q(); // restore prev graph state from stack
 
@@ -1498,6 +1545,9 @@ void PDF2dExportDevice::setCapJoin(PDFLineCap linecap, PDFLineJoin linejoin)
 {
   PDFIContentCommands *pOut = cc();
 
+  if (m_CapStyle != linecap || m_JoinStyle != linejoin)
+    GraphStateChanged();
+
   if (m_CapStyle != linecap)
   {
     m_CapStyle = linecap;
@@ -1729,6 +1779,7 @@ void PDF2dExportDevice::dc_mergeLines()
     pExtGsSub->AddItem(name, pExtGState);
     if (!pResDictPage.isNull())
       pResDictPage->setExtGState(pExtGsSub);
+    GraphStateChanged();
     PDFIContentCommands *pOut = cc();
     pOut->gs(PDFName::createObject(document(), name.c_str()));
   }
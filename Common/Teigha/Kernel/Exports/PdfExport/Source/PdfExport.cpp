@@ -39,6 +39,7 @@
 
 #include "PdfExportImpl.h"
 #include "PdfExportImplXObject.h"
+#include "PdfShxGlyphCache.h"
 
 #include "PdfExportParamsForXObject.h"
 
@@ -272,7 +273,10 @@ class OdPdfExportModule : public PdfExportModule
 {
 public:
   virtual void initApp(){}
-  virtual void uninitApp(){}
+  virtual void uninitApp()
+  {
+    PDFShxGlyphCache::instance().save();
+  }
 
   virtual OdPdfExportPtr create ()
   {
@@ -57,6 +57,9 @@
 #include "RxObject.h"
 #include "AbstractViewPE.h"
 #include "MemoryStream.h"
+#include "DbBaseHostAppServices.h"
+#include "MemFileStreamImpl.h"
+#include "RxSystemServices.h"
 
 namespace TD_PDF_2D_EXPORT {
 
@@ -492,8 +495,30 @@ PDFResultEx CPdfExportImpl::run()
 
 }
 
+// Deletes the temporary file holding the linearizer input, also if the export throws
+class PdfSpoolFileRemover
+{
+public:
+  OdString m_sFileName;
+
+  ~PdfSpoolFileRemover()
+  {
+    if (!m_sFileName.isEmpty())
+    {
+#ifdef OD_HAVE_REMOVE_FUNC
+      remove(m_sFileName);
+#else
+      DeleteFile(m_sFileName.c_str());
+#endif
+    }
+  }
+};
+
 PDFResultEx CPdfExportImpl::exportFile()
 {
+  // declared first, so the file is closed before it is deleted
+  PdfSpoolFileRemover spoolFile;
+
   // export PDF object tree to output stream
   PDFIStreamPtr outputStream = PDFIStream::createObject();
   OdStreamBufPtr linearizedOutput;
@@ -501,7 +526,13 @@ PDFResultEx CPdfExportImpl::exportFile()
     outputStream->setStreamBuf(m_ParamsHolder.getParams().output());
   else
   {
-    linearizedOutput = OdMemoryStream::createNew();
+    // The non-linearized document is only an input for qpdf, which reads it back with a seek
+    // per object. Spool it to a plain temporary file, so these reads are served by the file
+    // cache; a paged memory stream would reload its single swapped-in page on each miss.
+    OdDbBaseDatabase* pDb = m_ParamsHolder.getParams().database();
+    spoolFile.m_sFileName = TmpFileHelper::getTempFile(OdDbBaseDatabasePEPtr(pDb)->appServices(pDb));
+    linearizedOutput = ::odrxSystemServices()->createFile(spoolFile.m_sFileName,
+      (Oda::FileAccessMode)(Oda::kFileRead | Oda::kFileWrite), Oda::kShareDenyReadWrite, Oda::kCreateAlways);
     outputStream->setStreamBuf(linearizedOutput);
   }
   m_ParamsHolder.document().Export(outputStream, ver2ver(m_ParamsHolder.getParams().version()) );
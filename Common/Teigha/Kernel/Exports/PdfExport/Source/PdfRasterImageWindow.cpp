@@ -0,0 +1,188 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//
+//////////////////////////////////////////////////////////////////////
+
+
+#include "PdfExportCommon.h"
+#include "PdfRasterImageWindow.h"
+#include "RxObjectImpl.h"
+
+namespace TD_PDF_2D_EXPORT {
+
+PDFRasterImageWindow::PDFRasterImageWindow()
+  : m_x(0)
+  , m_y(0)
+  , m_srcWidth(0)
+  , m_srcHeight(0)
+  , m_width(0)
+  , m_height(0)
+{
+}
+
+OdGiRasterImagePtr PDFRasterImageWindow::createObject(const OdGiRasterImage* pOrig, OdUInt32 x, OdUInt32 y, OdUInt32 srcWidth, OdUInt32 srcHeight,
+                                                      OdUInt32 width, OdUInt32 height)
+{
+  OdGiRasterImagePtr pRes = pOrig;
+
+  OdUInt32 fullWidth = pOrig->pixelWidth(), fullHeight = pOrig->pixelHeight();
+  if (x >= fullWidth || y >= fullHeight || !width || !height)
+    return pRes;
+
+  bool bResample = (width != srcWidth || height != srcHeight);
+  srcWidth = odmin(srcWidth, fullWidth - x);
+  srcHeight = odmin(srcHeight, fullHeight - y);
+  if (!srcWidth || !srcHeight)
+    return pRes;
+  if (!bResample)
+  {
+    width = srcWidth;
+    height = srcHeight;
+  }
+  if (!x && !y && srcWidth == fullWidth && srcHeight == fullHeight && width == srcWidth && height == srcHeight)
+    return pRes;
+
+  OdSmartPtr<PDFRasterImageWindow> pWnd = OdRxObjectImpl<PDFRasterImageWindow>::createObject();
+  pWnd->m_pImage = pOrig;
+  pWnd->m_x = x;
+  pWnd->m_y = y;
+  pWnd->m_srcWidth = srcWidth;
+  pWnd->m_srcHeight = srcHeight;
+  pWnd->m_width = width;
+  pWnd->m_height = height;
+  return pWnd;
+}
+
+OdUInt32 PDFRasterImageWindow::scanLineSize() const
+{
+  OdUInt32 nAlign = odmax(scanLinesAlignment(), OdUInt32(1));
+  OdUInt32 nBytes = (m_width * colorDepth() + 7) / 8;
+  return (nBytes + nAlign - 1) / nAlign * nAlign;
+}
+
+const OdUInt8 *PDFRasterImageWindow::sourceLine(OdUInt32 index) const
+{
+  const OdUInt8 *pLines = m_pImage->scanLines();
+  if (pLines)
+    return pLines + OdUInt64(index) * m_pImage->scanLineSize();
+
+  m_SrcLine.resize(m_pImage->scanLineSize());
+  m_pImage->scanLines(m_SrcLine.asArrayPtr(), index, 1);
+  return m_SrcLine.getPtr();
+}
+
+// maps column or scanline of the resulting image to the center of its area in the original
+static inline OdUInt32 nearestSource(OdUInt32 i, OdUInt32 nSrc, OdUInt32 nDst)
+{
+  return (nSrc == nDst) ? i : OdUInt32((OdUInt64(i) * 2 + 1) * nSrc / (OdUInt64(nDst) * 2));
+}
+
+void PDFRasterImageWindow::copyLine(OdUInt8 *pDst, const OdUInt8 *pSrc) const
+{
+  OdUInt32 nBits = colorDepth();
+  if (!(nBits % 8))
+  {
+    OdUInt32 nBytes = nBits / 8;
+    if (m_width == m_srcWidth)
+    {
+      ::memcpy(pDst, pSrc + m_x * nBytes, m_width * nBytes);
+      return;
+    }
+    for (OdUInt32 c = 0; c < m_width; ++c, pDst += nBytes)
+      ::memcpy(pDst, pSrc + (m_x + nearestSource(c, m_srcWidth, m_width)) * nBytes, nBytes);
+    return;
+  }
+
+  // 1, 2 and 4 bits per pixel, the leftmost pixel is in the high order bits
+  OdUInt8 nMask = OdUInt8((1 << nBits) - 1);
+  ::memset(pDst, 0, (m_width * nBits + 7) / 8);
+  for (OdUInt32 c = 0; c < m_width; ++c)
+  {
+    OdUInt32 nSrcBit = (m_x + nearestSource(c, m_srcWidth, m_width)) * nBits;
+    OdUInt8 val = OdUInt8(pSrc[nSrcBit / 8] >> (8 - nBits - nSrcBit % 8)) & nMask;
+    OdUInt32 nDstBit = c * nBits;
+    pDst[nDstBit / 8] |= OdUInt8(val << (8 - nBits - nDstBit % 8));
+  }
+}
+
+void PDFRasterImageWindow::averageLines(OdUInt8 *pDst, OdUInt32 firstLine, OdUInt32 numLines) const
+{
+  OdUInt32 nBytes = colorDepth() / 8;
+  m_Sums.resize(m_width * nBytes);
+  ::memset(m_Sums.asArrayPtr(), 0, m_Sums.size() * sizeof(OdUInt32));
+
+  for (OdUInt32 r = 0; r < numLines; ++r)
+  {
+    const OdUInt8 *pSrc = sourceLine(firstLine + r);
+    OdUInt32 *pSum = m_Sums.asArrayPtr();
+    for (OdUInt32 c = 0; c < m_width; ++c, pSum += nBytes)
+    {
+      OdUInt32 sx0 = m_x + OdUInt32(OdUInt64(c) * m_srcWidth / m_width);
+      OdUInt32 sx1 = odmax(m_x + OdUInt32(OdUInt64(c + 1) * m_srcWidth / m_width), sx0 + 1);
+      for (const OdUInt8 *pPix = pSrc + sx0 * nBytes, *pEnd = pSrc + sx1 * nBytes; pPix < pEnd; pPix += nBytes)
+      {
+        for (OdUInt32 b = 0; b < nBytes; ++b)
+          pSum[b] += pPix[b];
+      }
+    }
+  }
+
+  const OdUInt32 *pSum = m_Sums.getPtr();
+  for (OdUInt32 c = 0; c < m_width; ++c, pSum += nBytes, pDst += nBytes)
+  {
+    OdUInt32 sx0 = OdUInt32(OdUInt64(c) * m_srcWidth / m_width);
+    OdUInt32 sx1 = odmax(OdUInt32(OdUInt64(c + 1) * m_srcWidth / m_width), sx0 + 1);
+    OdUInt32 nCount = (sx1 - sx0) * numLines;
+    for (OdUInt32 b = 0; b < nBytes; ++b)
+      pDst[b] = OdUInt8((pSum[b] + nCount / 2) / nCount);
+  }
+}
+
+void PDFRasterImageWindow::scanLines(OdUInt8* pBytes, OdUInt32 index, OdUInt32 numLines) const
+{
+  OdUInt32 nLineSize = scanLineSize();
+  OdUInt32 nBits = colorDepth();
+  // box filter needs whole bytes per channel, 16 bits per pixel formats pack channels in bits
+  bool bAverage = (m_width != m_srcWidth || m_height != m_srcHeight) && nBits >= 8 && !(nBits % 8) && nBits != 16 && !numColors();
+
+  for (OdUInt32 i = 0; i < numLines; ++i, pBytes += nLineSize)
+  {
+    ::memset(pBytes, 0, nLineSize);
+    OdUInt32 row = index + i;
+    if (bAverage)
+    {
+      OdUInt32 sy0 = OdUInt32(OdUInt64(row) * m_srcHeight / m_height);
+      OdUInt32 sy1 = odmax(OdUInt32(OdUInt64(row + 1) * m_srcHeight / m_height), sy0 + 1);
+      averageLines(pBytes, m_y + sy0, sy1 - sy0);
+    }
+    else
+    {
+      copyLine(pBytes, sourceLine(m_y + nearestSource(row, m_srcHeight, m_height)));
+    }
+  }
+}
+
+}
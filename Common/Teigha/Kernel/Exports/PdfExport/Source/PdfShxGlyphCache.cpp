@@ -0,0 +1,394 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+//
+//
+//////////////////////////////////////////////////////////////////////
+
+
+#include "PdfExportCommon.h"
+#include "PdfShxGlyphCache.h"
+#include "PdfExport.h"
+#include "OdPlatformStreamer.h"
+#include "RxSystemServices.h"
+#include "OdStreamBuf.h"
+
+namespace TD_PDF_2D_EXPORT {
+
+static const OdUInt32 kShxGlyphCacheSignature = 0x58485350; // "PSHX"
+static const OdInt32  kShxGlyphCacheVersion   = 2;
+static const OdUInt32 kShxGlyphCacheDefaultLimit = 16 * 1024 * 1024;
+
+static PDFShxGlyphCache s_ShxGlyphCache;
+
+PDFShxGlyphCache &PDFShxGlyphCache::instance()
+{
+  return s_ShxGlyphCache;
+}
+
+PDFShxGlyphCache::PDFShxGlyphCache()
+  : m_nMemoryUsed(0)
+  , m_nMemoryLimit(kShxGlyphCacheDefaultLimit)
+  , m_bModified(false)
+{
+}
+
+bool PDFShxGlyphCache::find(const OdString &fontFile, OdChar ch, OdUInt32 flags, PDFShxGlyphGeom &geom)
+{
+  GlyphKey key;
+  key.m_FontFile = fontFile;
+  key.m_ch = ch;
+  key.m_flags = flags;
+
+  TD_AUTOLOCK(m_Mutex);
+  GlyphMap::iterator pIt = m_Glyphs.find(key);
+  if (pIt == m_Glyphs.end())
+    return false;
+
+  // move to the head of the LRU list
+  m_Lru.splice(m_Lru.begin(), m_Lru, pIt->second.m_Lru);
+  geom = pIt->second.m_Geom;
+  return true;
+}
+
+void PDFShxGlyphCache::add(const OdString &fontFile, OdChar ch, OdUInt32 flags, const PDFShxGlyphGeom &geom)
+{
+  GlyphKey key;
+  key.m_FontFile = fontFile;
+  key.m_ch = ch;
+  key.m_flags = flags;
+
+  TD_AUTOLOCK(m_Mutex);
+  if (m_FontStamps.find(fontFile) == m_FontStamps.end())
+  {
+    FontStamp stamp;
+    if (getFontStamp(fontFile, stamp))
+      m_FontStamps[fontFile] = stamp;
+  }
+  addEntry(key, geom);
+}
+
+bool PDFShxGlyphCache::getFontStamp(const OdString &fontFile, FontStamp &stamp)
+{
+  OdRxSystemServices *pSs = ::odrxSystemServices();
+  if (!pSs || !pSs->accessFile(fontFile, Oda::kFileRead))
+    return false;
+  stamp.m_nSize = pSs->getFileSize(fontFile);
+  stamp.m_nMTime = pSs->getFileMTime(fontFile);
+  return stamp.m_nSize >= 0;
+}
+
+void PDFShxGlyphCache::addEntry(const GlyphKey &key, const PDFShxGlyphGeom &geom)
+{
+  OdUInt32 nBytes = geom.memoryUsage();
+  if (nBytes > m_nMemoryLimit || m_Glyphs.find(key) != m_Glyphs.end())
+    return;
+
+  m_Lru.push_front(key);
+  GlyphEntry &entry = m_Glyphs[key];
+  entry.m_Geom = geom;
+  entry.m_nBytes = nBytes;
+  entry.m_Lru = m_Lru.begin();
+
+  m_nMemoryUsed += nBytes;
+  m_bModified = true;
+  evict();
+}
+
+void PDFShxGlyphCache::evict()
+{
+  while (m_nMemoryUsed > m_nMemoryLimit && !m_Lru.empty())
+  {
+    GlyphMap::iterator pIt = m_Glyphs.find(m_Lru.back());
+    ODA_ASSERT(pIt != m_Glyphs.end());
+    m_nMemoryUsed -= pIt->second.m_nBytes;
+    m_Glyphs.erase(pIt);
+    m_Lru.pop_back();
+  }
+}
+
+void PDFShxGlyphCache::setMemoryLimit(OdUInt32 nBytes)
+{
+  TD_AUTOLOCK(m_Mutex);
+  m_nMemoryLimit = nBytes;
+  evict();
+}
+
+OdUInt32 PDFShxGlyphCache::memoryLimit() const
+{
+  TD_AUTOLOCK(m_Mutex);
+  return m_nMemoryLimit;
+}
+
+void PDFShxGlyphCache::clear()
+{
+  TD_AUTOLOCK(m_Mutex);
+  m_Glyphs.clear();
+  m_FontStamps.clear();
+  m_Lru.clear();
+  m_nMemoryUsed = 0;
+  m_bModified = false;
+}
+
+void PDFShxGlyphCache::setFile(const OdString &fileName)
+{
+  TD_AUTOLOCK(m_Mutex);
+  if (m_FileName == fileName)
+    return;
+  save();
+  m_FileName = fileName;
+  load();
+}
+
+OdString PDFShxGlyphCache::file() const
+{
+  TD_AUTOLOCK(m_Mutex);
+  return m_FileName;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Cache file: signature, version, number of fonts and for each font its file name, size and
+// modification time, then number of glyphs and for each glyph font file name, character, flags,
+// advance, polylines, arcs, outer and inner contours. Glyphs of fonts without stamp aren't saved.
+
+static void wrPoints(OdStreamBuf &stream, const OdGePoint3dArray &points)
+{
+  OdPlatformStreamer::wrInt32(stream, (OdInt32)points.size());
+  if (!points.isEmpty())
+    OdPlatformStreamer::wrDoubles(stream, (int)points.size() * 3, points.getPtr());
+}
+
+static void wrPoints(OdStreamBuf &stream, const OdGePoint2dArray &points)
+{
+  OdPlatformStreamer::wrInt32(stream, (OdInt32)points.size());
+  if (!points.isEmpty())
+    OdPlatformStreamer::wrDoubles(stream, (int)points.size() * 2, points.getPtr());
+}
+
+template <class TPointArray>
+static void wrPointArrays(OdStreamBuf &stream, const OdArray<TPointArray> &arrays)
+{
+  OdPlatformStreamer::wrInt32(stream, (OdInt32)arrays.size());
+  for (OdUInt32 f = 0; f < arrays.size(); ++f)
+    wrPoints(stream, arrays[f]);
+}
+
+static OdInt32 rdCount(OdStreamBuf &stream)
+{
+  OdInt32 nCount = OdPlatformStreamer::rdInt32(stream);
+  // each element takes at least 4 bytes in the file
+  if (nCount < 0 || OdUInt64(nCount) * 4 > stream.length() - stream.tell())
+    throw OdError(eInvalidInput);
+  return nCount;
+}
+
+static void rdPoints(OdStreamBuf &stream, OdGePoint3dArray &points)
+{
+  points.resize(rdCount(stream));
+  if (!points.isEmpty())
+    OdPlatformStreamer::rdDoubles(stream, (int)points.size() * 3, points.asArrayPtr());
+}
+
+static void rdPoints(OdStreamBuf &stream, OdGePoint2dArray &points)
+{
+  points.resize(rdCount(stream));
+  if (!points.isEmpty())
+    OdPlatformStreamer::rdDoubles(stream, (int)points.size() * 2, points.asArrayPtr());
+}
+
+template <class TPointArray>
+static void rdPointArrays(OdStreamBuf &stream, OdArray<TPointArray> &arrays)
+{
+  arrays.resize(rdCount(stream));
+  for (OdUInt32 f = 0; f < arrays.size(); ++f)
+    rdPoints(stream, arrays[f]);
+}
+
+void PDFShxGlyphCache::load()
+{
+  OdRxSystemServices *pSs = ::odrxSystemServices();
+  if (m_FileName.isEmpty() || !pSs || !pSs->accessFile(m_FileName, Oda::kFileRead))
+    return;
+
+  bool bModified = m_bModified;
+  try
+  {
+    OdStreamBufPtr pStream = pSs->createFile(m_FileName, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+    OdStreamBuf &stream = *pStream;
+
+    if (OdUInt32(OdPlatformStreamer::rdInt32(stream)) != kShxGlyphCacheSignature
+      || OdPlatformStreamer::rdInt32(stream) != kShxGlyphCacheVersion)
+    {
+      return;
+    }
+
+    // fonts whose file still has the size and time it had when its glyphs were saved
+    std::map<OdString, bool> fontValid;
+    OdInt32 nFonts = rdCount(stream);
+    for (OdInt32 i = 0; i < nFonts; ++i)
+    {
+      OdString fontFile = OdPlatformStreamer::rdString(stream);
+      FontStamp savedStamp, stamp;
+      savedStamp.m_nSize = OdPlatformStreamer::rdInt64(stream);
+      savedStamp.m_nMTime = OdPlatformStreamer::rdInt64(stream);
+
+      bool bValid = getFontStamp(fontFile, stamp) && stamp == savedStamp;
+      FontStampMap::const_iterator pStamp = m_FontStamps.find(fontFile);
+      if (pStamp != m_FontStamps.end())
+        bValid = bValid && pStamp->second == savedStamp;
+      else if (bValid)
+        m_FontStamps[fontFile] = savedStamp;
+      fontValid[fontFile] = bValid;
+    }
+
+    OdInt32 nGlyphs = rdCount(stream);
+    for (OdInt32 i = 0; i < nGlyphs; ++i)
+    {
+      GlyphKey key;
+      key.m_FontFile = OdPlatformStreamer::rdString(stream);
+      key.m_ch = (OdChar)OdPlatformStreamer::rdInt32(stream);
+      key.m_flags = (OdUInt32)OdPlatformStreamer::rdInt32(stream);
+
+      PDFShxGlyphGeom geom;
+      OdPlatformStreamer::rd2Doubles(stream, &geom.m_adv);
+      rdPointArrays(stream, geom.m_Lines);
+
+      geom.m_Circles.resize(rdCount(stream));
+      for (OdUInt32 f = 0; f < geom.m_Circles.size(); ++f)
+      {
+        OdGePoint3d center;
+        OdGeVector3d normal, refVec;
+        double params[3]; // radius, start and end angles
+        OdPlatformStreamer::rd3Doubles(stream, &center);
+        OdPlatformStreamer::rd3Doubles(stream, &normal);
+        OdPlatformStreamer::rd3Doubles(stream, &refVec);
+        OdPlatformStreamer::rdDoubles(stream, 3, params);
+        geom.m_Circles[f].set(center, normal, refVec, params[0], params[1], params[2]);
+      }
+
+      rdPointArrays(stream, geom.m_OuterContours);
+      rdPointArrays(stream, geom.m_InnerContours);
+
+      std::map<OdString, bool>::const_iterator pValid = fontValid.find(key.m_FontFile);
+      if (pValid != fontValid.end() && pValid->second)
+        addEntry(key, geom);
+    }
+  }
+  catch (const OdError &)
+  {
+    // damaged cache file, keep the glyphs read so far
+  }
+  // glyphs read from the file don't need to be written back
+  m_bModified = bModified;
+}
+
+bool PDFShxGlyphCache::save()
+{
+  TD_AUTOLOCK(m_Mutex);
+  if (m_FileName.isEmpty() || !m_bModified)
+    return true;
+
+  OdRxSystemServices *pSs = ::odrxSystemServices();
+  if (!pSs)
+    return false;
+
+  try
+  {
+    OdStreamBufPtr pStream = pSs->createFile(m_FileName, Oda::kFileWrite, Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+    OdStreamBuf &stream = *pStream;
+
+    OdPlatformStreamer::wrInt32(stream, (OdInt32)kShxGlyphCacheSignature);
+    OdPlatformStreamer::wrInt32(stream, kShxGlyphCacheVersion);
+
+    OdPlatformStreamer::wrInt32(stream, (OdInt32)m_FontStamps.size());
+    FontStampMap::const_iterator pStamp = m_FontStamps.begin();
+    for (; pStamp != m_FontStamps.end(); ++pStamp)
+    {
+      OdPlatformStreamer::wrString(stream, pStamp->first);
+      OdPlatformStreamer::wrInt64(stream, pStamp->second.m_nSize);
+      OdPlatformStreamer::wrInt64(stream, pStamp->second.m_nMTime);
+    }
+
+    OdInt32 nGlyphs = 0;
+    GlyphLruList::reverse_iterator pIt = m_Lru.rbegin();
+    for (; pIt != m_Lru.rend(); ++pIt)
+    {
+      if (m_FontStamps.find(pIt->m_FontFile) != m_FontStamps.end())
+        ++nGlyphs;
+    }
+    OdPlatformStreamer::wrInt32(stream, nGlyphs);
+
+    // least recently used glyphs go first, so they are evicted first when the file is loaded under a smaller limit
+    for (pIt = m_Lru.rbegin(); pIt != m_Lru.rend(); ++pIt)
+    {
+      if (m_FontStamps.find(pIt->m_FontFile) == m_FontStamps.end())
+        continue;
+      GlyphMap::const_iterator pEntry = m_Glyphs.find(*pIt);
+      ODA_ASSERT(pEntry != m_Glyphs.end());
+      const PDFShxGlyphGeom &geom = pEntry->second.m_Geom;
+
+      OdPlatformStreamer::wrString(stream, pIt->m_FontFile);
+      OdPlatformStreamer::wrInt32(stream, (OdInt32)pIt->m_ch);
+      OdPlatformStreamer::wrInt32(stream, (OdInt32)pIt->m_flags);
+
+      OdPlatformStreamer::wr2Doubles(stream, &geom.m_adv);
+      wrPointArrays(stream, geom.m_Lines);
+
+      OdPlatformStreamer::wrInt32(stream, (OdInt32)geom.m_Circles.size());
+      for (OdUInt32 f = 0; f < geom.m_Circles.size(); ++f)
+      {
+        const OdGeCircArc3d &arc = geom.m_Circles[f];
+        OdGePoint3d center = arc.center();
+        OdGeVector3d normal = arc.normal(), refVec = arc.refVec();
+        double params[3] = { arc.radius(), arc.startAng(), arc.endAng() };
+        OdPlatformStreamer::wr3Doubles(stream, &center);
+        OdPlatformStreamer::wr3Doubles(stream, &normal);
+        OdPlatformStreamer::wr3Doubles(stream, &refVec);
+        OdPlatformStreamer::wrDoubles(stream, 3, params);
+      }
+
+      wrPointArrays(stream, geom.m_OuterContours);
+      wrPointArrays(stream, geom.m_InnerContours);
+    }
+  }
+  catch (const OdError &)
+  {
+    return false;
+  }
+
+  m_bModified = false;
+  return true;
+}
+
+void setShxGlyphCacheFile(const OdString &fileName)
+{
+  PDFShxGlyphCache::instance().setFile(fileName);
+}
+
+OdString shxGlyphCacheFile()
+{
+  return PDFShxGlyphCache::instance().file();
+}
+
+}
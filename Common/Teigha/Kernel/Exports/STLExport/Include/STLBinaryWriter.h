@@ -0,0 +1,201 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// STLBinaryWriter.h - binary STL record output used by STL Export
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _STL_BINARY_WRITER_INCLUDED_
+#define _STL_BINARY_WRITER_INCLUDED_
+
+#include "OdaCommon.h"
+#include "OdStreamBuf.h"
+#include "OdError.h"
+#include "UInt8Array.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+
+namespace TD_STL_EXPORT
+{
+
+  /** \details
+     Packs binary STL triangle records into a reusable block and passes every full block
+     to the output stream with a single putBytes call.
+
+     A record is the normal and three vertices (twelve little-endian floats) followed by
+     a zero attribute byte count.
+  */
+  class OdSTLBinaryRecordBlock
+  {
+  public:
+    enum { kRecordSize = 50, kBlockRecords = 4096 };
+
+    OdSTLBinaryRecordBlock()
+      : m_nRecords(0)
+    {
+    }
+
+    // allocates the block and drops records which were not flushed
+    void reset()
+    {
+      m_block.resize(kBlockRecords * kRecordSize);
+      m_nRecords = 0;
+    }
+
+    // packs a record from twelve floats: normal, then vertices in order
+    void add(const float *pCoords, OdStreamBuf &stream)
+    {
+      if (m_nRecords == kBlockRecords)
+        flush(stream);
+      OdUInt8 *pRecord = m_block.asArrayPtr() + m_nRecords * kRecordSize;
+      ::memcpy(pRecord, pCoords, sizeof(float) * 12);
+      pRecord[48] = pRecord[49] = 0; // attribute byte count
+      ++m_nRecords;
+    }
+
+    // writes the records packed so far
+    void flush(OdStreamBuf &stream)
+    {
+      if (m_nRecords)
+      {
+        stream.putBytes(m_block.asArrayPtr(), m_nRecords * kRecordSize);
+        m_nRecords = 0;
+      }
+    }
+
+  private:
+    OdUInt8Array m_block;
+    OdUInt32 m_nRecords;
+  };
+
+  /** \details
+     Unbuffered stream over a file descriptor opened by the caller, the descriptor is not
+     closed. OdSTLBinaryRecordBlock already batches records, so every block goes straight
+     to write() without an intermediate copy.
+  */
+  class OdSTLDescriptorStream : public OdStreamBuf
+  {
+    int m_fd;
+  public:
+    OdSTLDescriptorStream()
+      : m_fd(-1)
+    {
+    }
+
+    void setDescriptor(int fd)
+    {
+      m_fd = fd;
+    }
+
+    virtual OdUInt64 seek(OdInt64 offset, OdDb::FilerSeekType seekType)
+    {
+      int whence = (seekType == OdDb::kSeekFromStart) ? SEEK_SET : (seekType == OdDb::kSeekFromEnd) ? SEEK_END : SEEK_CUR;
+#ifdef _WIN32
+      OdInt64 nPos = _lseeki64(m_fd, offset, whence);
+#else
+      OdInt64 nPos = (OdInt64)::lseek(m_fd, (off_t)offset, whence);
+#endif
+      if (nPos < 0)
+        throw OdError(eFileInternalErr);
+      return (OdUInt64)nPos;
+    }
+
+    virtual OdUInt64 tell()
+    {
+      return seek(0, OdDb::kSeekFromCurrent);
+    }
+
+    virtual OdUInt64 length()
+    {
+      OdUInt64 nPos = tell();
+      OdUInt64 nLength = seek(0, OdDb::kSeekFromEnd);
+      seek((OdInt64)nPos, OdDb::kSeekFromStart);
+      return nLength;
+    }
+
+    virtual bool isEof()
+    {
+      return tell() >= length();
+    }
+
+    virtual void getBytes(void* buffer, OdUInt32 numBytes)
+    {
+      OdUInt8 *pBuf = (OdUInt8*)buffer;
+      while (numBytes)
+      {
+#ifdef _WIN32
+        int nRead = _read(m_fd, pBuf, numBytes);
+#else
+        ssize_t nRead = ::read(m_fd, pBuf, numBytes);
+#endif
+        if (nRead < 0)
+          throw OdError(eFileInternalErr);
+        if (nRead == 0)
+          throw OdError(eEndOfFile);
+        pBuf += nRead;
+        numBytes -= (OdUInt32)nRead;
+      }
+    }
+
+    virtual OdUInt8 getByte()
+    {
+      OdUInt8 value;
+      getBytes(&value, 1);
+      return value;
+    }
+
+    virtual void putBytes(const void* buffer, OdUInt32 numBytes)
+    {
+      const OdUInt8 *pBuf = (const OdUInt8*)buffer;
+      while (numBytes)
+      {
+#ifdef _WIN32
+        int nWritten = _write(m_fd, pBuf, numBytes);
+#else
+        ssize_t nWritten = ::write(m_fd, pBuf, numBytes);
+#endif
+        if (nWritten <= 0)
+          throw OdError(eFileWriteError);
+        pBuf += nWritten;
+        numBytes -= (OdUInt32)nWritten;
+      }
+    }
+
+    virtual void putByte(OdUInt8 value)
+    {
+      putBytes(&value, 1);
+    }
+  };
+
+};
+
+#endif // _STL_BINARY_WRITER_INCLUDED_
@@ -35,6 +35,7 @@
 #include "Gi/GiDrawable.h"
 #include "OdStreamBuf.h"
 #include "DbBaseDatabase.h"
+#include "Ge/GePoint3dArray.h"
 
 /** \details
   <group OdExport_Classes> 
@@ -47,24 +48,72 @@ namespace TD_STL_EXPORT
      
      Input : pEntity - element to export
              bTextMode - if true, export to ASCII STL format, else to binary STL format.
+             nTextPrecision - number of decimals (0..9) written by ASCII STL format.
      Output: pOutStream - output stream (file stream, memory stream)
     
      Return : eOk is ok
               or OdResult error code
   */
-  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation);
+  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision = 6);
 
   /** \details
      Exports an element to STL file with checking of solid topology
      
      Input : pEntity - element to export
              bTextMode - if true, export to ASCII STL format, else to binary STL format.
+             nTextPrecision - number of decimals (0..9) written by ASCII STL format.
      Output: pOutStream - output stream (file stream, memory stream)
+             pInvalidEdges - if set, receives end points (two per edge) of edges that are not shared
+                             by exactly two oppositely oriented triangles, when solid topology is checked
     
      Return : eOk is ok
               or OdResult error code
   */
-  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation);
+  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
+
+  /** \details
+     Exports an element to STL file writing triangles as they are produced, so the mesh
+     is never held in memory
+     
+     Input : pEntity - element to export
+             bTextMode - if true, export to ASCII STL format, else to binary STL format.
+             bCorrectSolid - if true, solid topology is checked as in exportSTLEx
+             nTextPrecision - number of decimals (0..9) written by ASCII STL format.
+     Output: pOutStream - output stream; for binary format it must support seek (and read if
+                          bCorrectSolid is set), the triangle count and facet orientation
+                          are patched after the last triangle
+             pInvalidEdges - if set, receives end points (two per edge) of edges that are not shared
+                             by exactly two oppositely oriented triangles, when solid topology is checked
+    
+     Return : eOk is ok
+              or OdResult error code
+
+     Remarks: coordinates are moved into positive octant by the element extents instead of
+              the tessellated points. ASCII output with bCorrectSolid is buffered as in exportSTLEx,
+              since facets can't be reoriented in place there.
+
+              ASCII numbers are always written with '.' separator, independently of the C locale.
+  */
+  OdResult exportSTLStreamed(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool bCorrectSolid = false, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
+
+  /** \details
+     Exports an element to STL file, writing streamed output (see exportSTLStreamed) directly
+     to a file descriptor without an intermediate stream buffer
+     
+     Input : pEntity - element to export
+             nFileDescriptor - descriptor opened for writing by the caller; it is not closed.
+                               For binary format it must be seekable (and readable if
+                               bCorrectSolid is set)
+             bTextMode - if true, export to ASCII STL format, else to binary STL format.
+             bCorrectSolid - if true, solid topology is checked as in exportSTLEx
+             nTextPrecision - number of decimals (0..9) written by ASCII STL format.
+     Output: pInvalidEdges - if set, receives end points (two per edge) of edges that are not shared
+                             by exactly two oppositely oriented triangles, when solid topology is checked
+    
+     Return : eOk is ok
+              or OdResult error code
+  */
+  OdResult exportSTLToDescriptor(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, int nFileDescriptor, bool bTextMode, double dDeviation, bool bCorrectSolid = false, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
 
 };
 
@@ -28,6 +28,7 @@
 #include "STLExportDef.h"
 #include "RxDynamicModule.h"
 #include "DbBaseDatabase.h"
+#include "Ge/GePoint3dArray.h"
 
 class OdGiDrawable;
 class OdStreamBuf;
@@ -56,8 +57,16 @@ namespace TD_STL_EXPORT
     /** \details
       Exports to the STL.
     */
-    virtual OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation);
-    virtual OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation);
+    virtual OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision = 6);
+    virtual OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
+    /** \details
+      Exports to the STL writing triangles as they are produced (see TD_STL_EXPORT::exportSTLStreamed).
+    */
+    virtual OdResult exportSTLStreamed(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool bCorrectSolid = false, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
+    /** \details
+      Exports to the STL writing directly to a file descriptor (see TD_STL_EXPORT::exportSTLToDescriptor).
+    */
+    virtual OdResult exportSTLToDescriptor(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, int nFileDescriptor, bool bTextMode, double dDeviation, bool bCorrectSolid = false, int nTextPrecision = 6, OdGePoint3dArray *pInvalidEdges = 0);
   };
 
   /** \details
@@ -37,6 +37,13 @@
 #include "RxDynamicModule.h"
 #include "OdDToStr.h"
 #include "Ge/GeGbl.h"
+#include "UInt8Array.h"
+#include "UInt32Array.h"
+#include "Ge/GePoint3dArray.h"
+#include "RxThreadPoolLoop.h"
+#include "DynamicLinker.h"
+#include "OdModuleNames.h"
+#include "STLBinaryWriter.h"
 
 #define STL_USING_LIMITS
 #define STL_USING_VECTOR
@@ -218,14 +225,466 @@ namespace TD_STL_EXPORT
       {
         return p1.same(p2, tol) || p1.same(p3, tol) || p3.same(p2, tol);
       }
+
+      void flip()
+      {
+        Od3Float dummy = p2;
+        p2 = p3;
+        p3 = dummy;
+
+        if (!(normal.x == 0 && normal.y == 0 && normal.z == 0))
+        {
+          //to recalculate normal or just inverse it?
+          normal.x *= -1;
+          normal.y *= -1;
+          normal.z *= -1;
+          /*
+          dummy = p2 - p1;
+          normal = dummy.crossProduct(p3 - p2);
+          normal.normalize();
+          */
+        }
+      }
+    };
+
+    // Matches vertices of the solid check. Coordinates are snapped to a grid of epsilon cells,
+    // so vertices closer than epsilon are one vertex, as geValidSolid matched them within
+    // epsilon, unless a grid line passes between them. Zero epsilon matches exact values.
+    class VertexGrid
+    {
+      double m_dScale;
+
+    public:
+      VertexGrid(float e = 0.f) : m_dScale(e > 0.f ? 1. / e : 0.) { }
+
+      OdInt64 cell(float f) const
+      {
+        if (m_dScale > 0.)
+        {
+          // rounded to the nearest cell, inline floor of the scaled value
+          double dCell = f * m_dScale + 0.5;
+          OdInt64 nCell = (OdInt64)dCell;
+          return (double)nCell > dCell ? nCell - 1 : nCell;
+        }
+        if (f == 0.f) // -0 and +0 are the same vertex
+          f = 0.f;
+        OdUInt32 nBits;
+        ::memcpy(&nBits, &f, sizeof(nBits));
+        return nBits;
+      }
+
+      // negative, zero or positive as a is before, in the same cell as or after b
+      int compare(const Od3Float &a, const Od3Float &b) const
+      {
+        OdInt64 nA = cell(a.x), nB = cell(b.x);
+        if (nA == nB)
+        {
+          nA = cell(a.y); nB = cell(b.y);
+          if (nA == nB)
+          {
+            nA = cell(a.z); nB = cell(b.z);
+          }
+        }
+        return (nA < nB) ? -1 : (nA > nB) ? 1 : 0;
+      }
+
+      bool less(const Od3Float &a, const Od3Float &b) const
+      {
+        return compare(a, b) < 0;
+      }
+
+      bool same(const Od3Float &a, const Od3Float &b) const
+      {
+        return cell(a.x) == cell(b.x) && cell(a.y) == cell(b.y) && cell(a.z) == cell(b.z);
+      }
+
+      // FNV-1a of the cells of p
+      OdUInt32 hash(const Od3Float &p, OdUInt32 nHash = 2166136261u) const
+      {
+        const float coords[3] = { p.x, p.y, p.z };
+        for (int n = 0; n < 3; ++n)
+        {
+          OdUInt64 nCell = (OdUInt64)cell(coords[n]);
+          nHash = (nHash ^ OdUInt32(nCell)) * 16777619u;
+          nHash = (nHash ^ OdUInt32(nCell >> 32)) * 16777619u;
+        }
+        return nHash;
+      }
+    };
+
+    // Solid check for streamed output: signed volume is accumulated per triangle and
+    // closure is tracked by edge usage, so triangles don't have to be kept.
+    // Vertices are matched by VertexGrid.
+    // Memory is about 20 bytes per distinct vertex plus an 8 byte key per triangle side,
+    // less than buffering the triangles themselves.
+    class IncrementalSolidCheck
+    {
+      OdArray<Od3Float, OdMemoryAllocator<Od3Float> > m_vertices;  // by vertex id
+      OdUInt32Array m_vertexTable; // open addressing hash of vertex id + 1, 0 is a free slot
+      OdArray<OdUInt64, OdMemoryAllocator<OdUInt64> > m_edges;     // (lo << 32) | (hi << 1) | reversed
+      bool      m_bSorted;
+      double    m_dVolume;
+      VertexGrid m_grid;
+
+      OdUInt32 vertexHash(const Od3Float &p) const
+      {
+        OdUInt32 nHash = m_grid.hash(p);
+        return nHash ^ (nHash >> 15);
+      }
+
+      void growVertexTable()
+      {
+        OdUInt32 nSize = odmax((OdUInt32)1024, m_vertexTable.size() * 2);
+        m_vertexTable.clear();
+        m_vertexTable.resize(nSize, 0);
+        OdUInt32 *pTable = m_vertexTable.asArrayPtr();
+        const Od3Float *pVertices = m_vertices.getPtr();
+        for (OdUInt32 nId = 0; nId < m_vertices.size(); ++nId)
+        {
+          OdUInt32 nSlot = vertexHash(pVertices[nId]) & (nSize - 1);
+          while (pTable[nSlot])
+            nSlot = (nSlot + 1) & (nSize - 1);
+          pTable[nSlot] = nId + 1;
+        }
+      }
+
+      OdUInt32 vertexId(const Od3Float &p)
+      {
+        if (m_vertices.size() * 2 >= m_vertexTable.size())
+          growVertexTable();
+        const OdUInt32 nMask = m_vertexTable.size() - 1;
+        OdUInt32 *pTable = m_vertexTable.asArrayPtr();
+        const Od3Float *pVertices = m_vertices.getPtr();
+        OdUInt32 nSlot = vertexHash(p) & nMask;
+        for (; pTable[nSlot]; nSlot = (nSlot + 1) & nMask)
+        {
+          if (m_grid.same(pVertices[pTable[nSlot] - 1], p))
+            return pTable[nSlot] - 1;
+        }
+        pTable[nSlot] = m_vertices.size() + 1;
+        m_vertices.append(p);
+        return m_vertices.size() - 1;
+      }
+
+      void addEdge(OdUInt32 a, OdUInt32 b)
+      {
+        m_edges.append((OdUInt64(odmin(a, b)) << 32) | (OdUInt64(odmax(a, b)) << 1) | (a > b ? 1 : 0));
+      }
+
+      // Sorts edge keys so uses of one edge are adjacent, returns the group size and
+      // whether it is used exactly once in each direction
+      OdUInt32 edgeGroup(OdUInt32 nFirst, bool &bValid)
+      {
+        if (!m_bSorted)
+        {
+          std::sort(m_edges.begin(), m_edges.end());
+          m_bSorted = true;
+        }
+        const OdUInt64 *pEdges = m_edges.getPtr();
+        OdUInt32 nLast = nFirst;
+        OdInt32 nBalance = 0;
+        while (nLast < m_edges.size() && (pEdges[nLast] >> 1) == (pEdges[nFirst] >> 1))
+          nBalance += (pEdges[nLast++] & 1) ? -1 : 1;
+        bValid = (nLast - nFirst == 2) && !nBalance;
+        return nLast - nFirst;
+      }
+
+    public:
+      IncrementalSolidCheck() : m_bSorted(true), m_dVolume(0.) { }
+
+      // must be set before the first triangle is added
+      void setEpsilon(float e)
+      {
+        m_grid = VertexGrid(e);
+      }
+
+      void add(const TriangleInfo &cell)
+      {
+        const double ax = cell.p1.x, ay = cell.p1.y, az = cell.p1.z;
+        const double bx = cell.p2.x, by = cell.p2.y, bz = cell.p2.z;
+        const double cx = cell.p3.x, cy = cell.p3.y, cz = cell.p3.z;
+        m_dVolume += (ax * (by * cz - bz * cy) + ay * (bz * cx - bx * cz) + az * (bx * cy - by * cx)) / 6.;
+
+        OdUInt32 i1 = vertexId(cell.p1), i2 = vertexId(cell.p2), i3 = vertexId(cell.p3);
+        addEdge(i1, i2);
+        addEdge(i2, i3);
+        addEdge(i3, i1);
+        m_bSorted = false;
+      }
+
+      // closed, consistently oriented mesh with inverted orientation
+      bool needsReorder()
+      {
+        if (m_edges.empty() || !(m_dVolume < 0))
+          return false;
+        bool bValid = true;
+        for (OdUInt32 n = 0; n < m_edges.size() && bValid; )
+          n += edgeGroup(n, bValid);
+        return bValid;
+      }
+
+      // Appends end points of edges not used by exactly two triangles in opposite directions,
+      // two points per edge; shift is added back to the written coordinates
+      void invalidEdges(OdGePoint3dArray &edges, const Od3Float &shift)
+      {
+        for (OdUInt32 n = 0; n < m_edges.size(); )
+        {
+          bool bValid;
+          OdUInt32 nUses = edgeGroup(n, bValid);
+          if (!bValid)
+          {
+            const Od3Float &a = m_vertices[OdUInt32(m_edges[n] >> 32)];
+            const Od3Float &b = m_vertices[OdUInt32(m_edges[n] >> 1) & 0x7FFFFFFF];
+            edges.append(OdGePoint3d((double)a.x + shift.x, (double)a.y + shift.y, (double)a.z + shift.z));
+            edges.append(OdGePoint3d((double)b.x + shift.x, (double)b.y + shift.y, (double)b.z + shift.z));
+          }
+          n += nUses;
+        }
+      }
+    };
+
+    // Solid check of buffered triangles. Triangles are split into fixed chunks and edges into
+    // fixed hash buckets, both processed on the ThreadPool module if it is available. Partial
+    // results are reduced in chunk and bucket order, so they don't depend on the thread count.
+    // Vertices are matched by VertexGrid, as in IncrementalSolidCheck.
+    class ParallelSolidCheck
+    {
+      enum { kChunkTriangles = 0x10000, kBuckets = 256 };
+
+      typedef void (ParallelSolidCheck::*Phase)(OdUInt32 nItem);
+
+      // Runs phase for an item.
+      struct PhaseBody
+      {
+        ParallelSolidCheck *m_pCheck;
+        Phase m_pPhase;
+
+        void operator()(OdUInt32 nItem, OdUInt32 /*nThread*/)
+        {
+          (m_pCheck->*m_pPhase)(nItem);
+        }
+      };
+
+      struct EdgeLess
+      {
+        const ParallelSolidCheck *m_pCheck;
+        EdgeLess(const ParallelSolidCheck *pCheck) : m_pCheck(pCheck) { }
+        bool operator()(OdUInt32 a, OdUInt32 b) const
+        {
+          int nKey = m_pCheck->keyCompare(a, b);
+          return nKey ? (nKey < 0) : (a < b);
+        }
+      };
+
+      const TriangleInfo       *m_pData;
+      OdUInt32                  m_nData;
+      OdUInt32                  m_nChunks;
+      Od3Float                  m_base;
+      VertexGrid                m_grid;
+      OdRxThreadPoolServicePtr  m_pThreadPool;
+      OdArray<double, OdMemoryAllocator<double> > m_chunkVolumes;
+      OdUInt32Array             m_chunkBucketPos; // [chunk * kBuckets + bucket] edge count, then scatter position
+      OdUInt32Array             m_bucketStart;    // kBuckets + 1 offsets into m_edges
+      OdUInt32Array             m_edges;          // edges (triangle * 3 + side) grouped by bucket
+      OdUInt32Array             m_badEdges[kBuckets];
+      double                   *m_pChunkVolumes;
+      OdUInt32                 *m_pChunkBucketPos;
+      OdUInt32                 *m_pEdges;
+
+      // Returns edge ends in vertex order and true if the edge runs from the lesser vertex
+      bool edgeKey(OdUInt32 nEdge, const Od3Float *&pLo, const Od3Float *&pHi) const
+      {
+        const TriangleInfo &cell = m_pData[nEdge / 3];
+        const Od3Float *pFrom, *pTo;
+        switch (nEdge % 3)
+        {
+          case 0:  pFrom = &cell.p1; pTo = &cell.p2; break;
+          case 1:  pFrom = &cell.p2; pTo = &cell.p3; break;
+          default: pFrom = &cell.p3; pTo = &cell.p1; break;
+        }
+        bool bForward = m_grid.less(*pFrom, *pTo);
+        pLo = bForward ? pFrom : pTo;
+        pHi = bForward ? pTo : pFrom;
+        return bForward;
+      }
+
+      // negative, zero or positive as the ends of edge a are before, same as or after those of b
+      int keyCompare(OdUInt32 a, OdUInt32 b) const
+      {
+        const Od3Float *pLoA, *pHiA, *pLoB, *pHiB;
+        edgeKey(a, pLoA, pHiA);
+        edgeKey(b, pLoB, pHiB);
+        int nLo = m_grid.compare(*pLoA, *pLoB);
+        return nLo ? nLo : m_grid.compare(*pHiA, *pHiB);
+      }
+
+      OdUInt32 edgeBucket(OdUInt32 nEdge) const
+      {
+        const Od3Float *pLo, *pHi;
+        edgeKey(nEdge, pLo, pHi);
+        OdUInt32 nHash = m_grid.hash(*pHi, m_grid.hash(*pLo));
+        return (nHash ^ (nHash >> 16)) % kBuckets;
+      }
+
+      // Per chunk: signed volume part and edge counts per bucket
+      void measureChunk(OdUInt32 nChunk)
+      {
+        const OdUInt32 nFirst = nChunk * kChunkTriangles;
+        const OdUInt32 nLast = odmin(nFirst + (OdUInt32)kChunkTriangles, m_nData);
+        OdUInt32 *pCounts = m_pChunkBucketPos + nChunk * kBuckets;
+        double dVolume = 0.;
+        for (OdUInt32 n = nFirst; n < nLast; ++n)
+        {
+          const TriangleInfo &cell = m_pData[n];
+          const double ax = cell.p1.x - m_base.x, ay = cell.p1.y - m_base.y, az = cell.p1.z - m_base.z;
+          const double bx = cell.p2.x - m_base.x, by = cell.p2.y - m_base.y, bz = cell.p2.z - m_base.z;
+          const double cx = cell.p3.x - m_base.x, cy = cell.p3.y - m_base.y, cz = cell.p3.z - m_base.z;
+          dVolume += ax * (by * cz - bz * cy) + ay * (bz * cx - bx * cz) + az * (bx * cy - by * cx);
+          ++pCounts[edgeBucket(n * 3)];
+          ++pCounts[edgeBucket(n * 3 + 1)];
+          ++pCounts[edgeBucket(n * 3 + 2)];
+        }
+        m_pChunkVolumes[nChunk] = dVolume / 6.;
+      }
+
+      // Per chunk: edges scattered into their buckets in triangle order
+      void scatterChunk(OdUInt32 nChunk)
+      {
+        const OdUInt32 nFirst = nChunk * kChunkTriangles * 3;
+        const OdUInt32 nLast = odmin(nFirst + (OdUInt32)kChunkTriangles * 3, m_nData * 3);
+        OdUInt32 *pPos = m_pChunkBucketPos + nChunk * kBuckets;
+        for (OdUInt32 nEdge = nFirst; nEdge < nLast; ++nEdge)
+          m_pEdges[pPos[edgeBucket(nEdge)]++] = nEdge;
+      }
+
+      // Per bucket: edges sorted and grouped, groups other than one forward and one backward use are kept
+      void matchBucket(OdUInt32 nBucket)
+      {
+        OdUInt32 *pEdge = m_pEdges + m_bucketStart[nBucket];
+        OdUInt32 *pEnd = m_pEdges + m_bucketStart[nBucket + 1];
+        std::sort(pEdge, pEnd, EdgeLess(this));
+        while (pEdge != pEnd)
+        {
+          OdUInt32 *pGroup = pEdge;
+          OdInt32 nBalance = 0;
+          do
+          {
+            const Od3Float *pLo, *pHi;
+            nBalance += edgeKey(*pEdge, pLo, pHi) ? 1 : -1;
+            ++pEdge;
+          }
+          while (pEdge != pEnd && !keyCompare(*pGroup, *pEdge));
+          if (pEdge - pGroup != 2 || nBalance != 0)
+            m_badEdges[nBucket].append(*pGroup);
+        }
+      }
+
+      void run(Phase pPhase, OdUInt32 nItems)
+      {
+        PhaseBody body;
+        body.m_pCheck = this;
+        body.m_pPhase = pPhase;
+        OdUInt32 nThreads = m_pThreadPool.isNull() ? 1 : (OdUInt32)odmax(m_pThreadPool->numCPUs(), 1);
+        odrxThreadPoolLoop(m_pThreadPool.get(), nThreads, nItems, body);
+      }
+
+    public:
+      ParallelSolidCheck(const TriangleInfo *pData, OdUInt32 nData, const Od3Float &base, float e)
+        : m_pData(pData), m_nData(nData), m_nChunks(0), m_base(base), m_grid(e)
+        , m_pChunkVolumes(0), m_pChunkBucketPos(0), m_pEdges(0)
+      {
+      }
+
+      // Signed volume relative to the base point, must be called first
+      double signedVolume()
+      {
+        m_nChunks = (m_nData + kChunkTriangles - 1) / kChunkTriangles;
+        if (m_nChunks > 1)
+          m_pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+        m_chunkVolumes.resize(m_nChunks, 0.);
+        m_chunkBucketPos.resize(m_nChunks * kBuckets, 0);
+        m_pChunkVolumes = m_chunkVolumes.asArrayPtr();
+        m_pChunkBucketPos = m_chunkBucketPos.asArrayPtr();
+        run(&ParallelSolidCheck::measureChunk, m_nChunks);
+
+        double dVolume = 0.;
+        for (OdUInt32 nChunk = 0; nChunk < m_nChunks; ++nChunk)
+          dVolume += m_pChunkVolumes[nChunk];
+        return dVolume;
+      }
+
+      // Returns true if every edge is used by exactly two triangles in opposite directions
+      bool validEdges()
+      {
+        m_bucketStart.resize(kBuckets + 1);
+        OdUInt32 nPos = 0;
+        for (OdUInt32 nBucket = 0; nBucket < kBuckets; ++nBucket)
+        {
+          m_bucketStart[nBucket] = nPos;
+          for (OdUInt32 nChunk = 0; nChunk < m_nChunks; ++nChunk)
+          {
+            OdUInt32 &nChunkPos = m_pChunkBucketPos[nChunk * kBuckets + nBucket];
+            OdUInt32 nCount = nChunkPos;
+            nChunkPos = nPos;
+            nPos += nCount;
+          }
+        }
+        m_bucketStart[kBuckets] = nPos;
+        m_edges.resize(nPos);
+        m_pEdges = m_edges.asArrayPtr();
+        run(&ParallelSolidCheck::scatterChunk, m_nChunks);
+        run(&ParallelSolidCheck::matchBucket, kBuckets);
+
+        for (OdUInt32 nBucket = 0; nBucket < kBuckets; ++nBucket)
+        {
+          if (!m_badEdges[nBucket].isEmpty())
+            return false;
+        }
+        return true;
+      }
+
+      // Appends end points of edges rejected by validEdges(), two points per edge
+      void invalidEdges(OdGePoint3dArray &edges) const
+      {
+        for (OdUInt32 nBucket = 0; nBucket < kBuckets; ++nBucket)
+        {
+          const OdUInt32Array &bad = m_badEdges[nBucket];
+          for (OdUInt32 n = 0; n < bad.size(); ++n)
+          {
+            const Od3Float *pLo, *pHi;
+            edgeKey(bad[n], pLo, pHi);
+            edges.append(OdGePoint3d(pLo->x, pLo->y, pLo->z));
+            edges.append(OdGePoint3d(pHi->x, pHi->y, pHi->z));
+          }
+        }
+      }
     };
 
     OdArray<TriangleInfo> m_Data;
     Od3Float              m_LowPoint;
 
+    bool                  m_bStreamed;  // triangles are written as they arrive, m_Data stays empty
+    Od3Float              m_Shift;      // streamed mode offset into positive octant
+    OdUInt32              m_nTriangles; // streamed mode triangle count
+    IncrementalSolidCheck m_SolidCheck;
+    OdGePoint3dArray     *m_pInvalidEdges; // receives edges failing the solid check, if set
+
     virtual void triangleOut(const TriangleInfo &cell) = 0;
     virtual void addTriangle(const TriangleInfo &cell)
     {
+      if (m_bStreamed)
+      {
+        TriangleInfo shifted(cell);
+        shifted.p1 = shifted.p1 - m_Shift;
+        shifted.p2 = shifted.p2 - m_Shift;
+        shifted.p3 = shifted.p3 - m_Shift;
+        if (fCorrectSolid)
+          m_SolidCheck.add(shifted);
+        triangleOut(shifted);
+        ++m_nTriangles;
+        return;
+      }
+
       compareMin(m_LowPoint, cell.p1);
       compareMin(m_LowPoint, cell.p2);
       compareMin(m_LowPoint, cell.p3);
@@ -262,15 +721,46 @@ namespace TD_STL_EXPORT
 
   public:
     OdSTLOutBase()
-      : m_pOutStream(0), m_LowPoint(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT)
+      : m_pOutStream(0), m_LowPoint(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT), m_bStreamed(false), m_nTriangles(0), m_pInvalidEdges(0)
     {
       
     }
 
+    void setInvalidEdges(OdGePoint3dArray *pInvalidEdges)
+    {
+      m_pInvalidEdges = pInvalidEdges;
+    }
+
+    // Switches to streamed output. Lowest point is taken from the element extents, since
+    // triangles are written before the tessellated lowest point is known.
+    // Returns false if the format can't be streamed with the current settings.
+    virtual bool setStreamed(const OdGeExtents3d &extents)
+    {
+      if (extents.isValidExtents())
+      {
+        Od3Float lowPoint;
+        lowPoint.set(extents.minPoint());
+        compareMin(m_LowPoint, lowPoint);
+      }
+      m_Shift.x = (m_LowPoint.x > 0) ? 0.f : m_LowPoint.x - MIN_FLOAT;
+      m_Shift.y = (m_LowPoint.y > 0) ? 0.f : m_LowPoint.y - MIN_FLOAT;
+      m_Shift.z = (m_LowPoint.z > 0) ? 0.f : m_LowPoint.z - MIN_FLOAT;
+      m_SolidCheck.setEpsilon(epsilon);
+      m_bStreamed = true;
+      return true;
+    }
+
     virtual void start() = 0;
 
     virtual void finish()
     {
+      if (m_bStreamed)
+      {
+        if (fCorrectSolid && m_pInvalidEdges)
+          m_SolidCheck.invalidEdges(*m_pInvalidEdges, m_Shift);
+        return;
+      }
+
       bool bX = m_LowPoint.x > 0;
       bool bY = m_LowPoint.y > 0;
       bool bZ = m_LowPoint.z > 0;
@@ -310,31 +800,15 @@ namespace TD_STL_EXPORT
       if (!fCorrectSolid)
         return;
 
-      //prepare data             
-      OdGePoint3dArray points;
-      points.resize(m_Data.size() * 3);
-      OdGePoint3dArray::iterator pPoint = points.begin();
-      OdArray<TriangleInfo>::iterator pIt = m_Data.begin();
-      OdArray<TriangleInfo>::iterator pEnd = m_Data.end();
-      while(pIt != pEnd)
+      ParallelSolidCheck check(m_Data.getPtr(), m_Data.size(), m_LowPoint, epsilon);
+      double vol = check.signedVolume();
+      if (vol < 0 || m_pInvalidEdges)
       {
-        pPoint->set(pIt->p1.x, pIt->p1.y, pIt->p1.z); ++pPoint;
-        pPoint->set(pIt->p2.x, pIt->p2.y, pIt->p2.z); ++pPoint;
-        pPoint->set(pIt->p3.x, pIt->p3.y, pIt->p3.z); ++pPoint;
-        ++pIt;
-      }
-
-      double vol;
-      OdGePoint3d base(m_LowPoint.x, m_LowPoint.y, m_LowPoint.z);
-      OdGeError e = geSolidSignedVolume(points, vol, &base);
-      if (e == OdGe::kOk && vol < 0)
-      {
-        bool isValid;
-        e = geValidSolid(points, isValid, epsilon);
-        if (e == OdGe::kOk && isValid)
-        {
+        bool isValid = check.validEdges();
+        if (!isValid && m_pInvalidEdges)
+          check.invalidEdges(*m_pInvalidEdges);
+        if (isValid && vol < 0)
           reorderTriangles();
-        }
       }
     }
 
@@ -358,22 +832,7 @@ namespace TD_STL_EXPORT
       OdArray<TriangleInfo>::iterator pEnd = m_Data.end();
       while(pIt != pEnd)
       {
-        Od3Float dummy = pIt->p2;
-        pIt->p2 = pIt->p3;
-        pIt->p3 = dummy;
-
-        if (!(pIt->normal.x == 0 && pIt->normal.y == 0 && pIt->normal.z == 0))
-        {
-          //to recalculate normal or just inverse it?
-          pIt->normal.x *= -1;
-          pIt->normal.y *= -1;
-          pIt->normal.z *= -1;
-          /*
-          dummy = pIt->p2 - pIt->p1;
-          pIt->normal = dummy.crossProduct(pIt->p3 - pIt->p2);
-          pIt->normal.normalize();
-          */
-        }
+        pIt->flip();
         ++pIt;
       }
     }
@@ -382,52 +841,159 @@ namespace TD_STL_EXPORT
 
   const float OdSTLOutBase::MIN_FLOAT = 0.01f;
 
-  double dfix(double d)
+  // Appends value in "%.<nDecimals>f" notation with '.' separator, independent of the C locale.
+  // Float mantissa times 10^nDecimals fits 64 bits, so rounding (half to even on the exact binary
+  // value, as printf does) is done in integers; huge magnitudes fall back to odDToStr.
+  static char *appendFixed(char *pDst, float value, int nDecimals)
   {
-    return OdZero(d) ? 0. : d;
+    static const OdUInt64 pow10[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+                                      10000000ull, 100000000ull, 1000000000ull };
+    int nExp = 0;
+    double dMant = ::frexp(OdZero(value) ? 0. : (double)value, &nExp);
+    bool bNeg = dMant < 0.;
+    OdUInt64 nMant = (OdUInt64)(bNeg ? -::ldexp(dMant, 24) : ::ldexp(dMant, 24));
+    nExp -= 24;
+    OdUInt64 nScaled = nMant * pow10[nDecimals]; // < 2^54
+    if (nExp > 0)
+    {
+      if (nExp >= 10 || (nScaled >> (63 - nExp)))
+      {
+        char buf[64];
+        odDToStr(buf, (double)value, 'f', nDecimals);
+        for (const char *pSrc = buf; *pSrc; ++pSrc)
+          *pDst++ = *pSrc;
+        return pDst;
+      }
+      nScaled <<= nExp;
+    }
+    else if (nExp < 0)
+    {
+      int nShift = -nExp;
+      if (nShift >= 64)
+        nScaled = 0;
+      else
+      {
+        OdUInt64 nRem = nScaled & ((OdUInt64(1) << nShift) - 1);
+        OdUInt64 nHalf = OdUInt64(1) << (nShift - 1);
+        nScaled >>= nShift;
+        if (nRem > nHalf || (nRem == nHalf && (nScaled & 1)))
+          ++nScaled;
+      }
+    }
+    if (bNeg)
+      *pDst++ = '-';
+    OdUInt64 nInt = nScaled / pow10[nDecimals];
+    OdUInt64 nFrac = nScaled % pow10[nDecimals];
+    char digits[20];
+    int nDigits = 0;
+    do
+    {
+      digits[nDigits++] = char('0' + nInt % 10);
+      nInt /= 10;
+    }
+    while (nInt);
+    while (nDigits)
+      *pDst++ = digits[--nDigits];
+    if (nDecimals)
+    {
+      *pDst++ = '.';
+      for (int n = nDecimals; n--; nFrac /= 10)
+        pDst[n] = char('0' + nFrac % 10);
+      pDst += nDecimals;
+    }
+    return pDst;
   }
 
   class OdSTLOutText : public OdSTLOutBase
   {
-  protected:
+    // enough for the longest facet: four lines of three numbers of up to 64 chars each
+    enum { kBlockSize = 0x40000, kMaxFacetChars = 1024 };
 
-    virtual void triangleOut(const TriangleInfo &cell)
+    int m_nPrecision;
+    OdUInt8Array m_block;     // facet text not yet passed to the stream
+    OdUInt32 m_nBlockUsed;
+
+    static char *appendText(char *pDst, const char *pText)
     {
-      OdAnsiString str;
-      str.format("   facet normal %ls %ls %ls\x0D\x0A", odDToStr(dfix(cell.normal.x), 'f', 6).c_str(), odDToStr(dfix(cell.normal.y), 'f', 6).c_str(), odDToStr(dfix(cell.normal.z), 'f', 6).c_str());
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
+      while (*pText)
+        *pDst++ = *pText++;
+      return pDst;
+    }
 
-      str = "      outer loop\x0D\x0A";
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
+    char *appendPoint(char *pDst, const Od3Float &pt) const
+    {
+      pDst = appendFixed(pDst, pt.x, m_nPrecision);
+      *pDst++ = ' ';
+      pDst = appendFixed(pDst, pt.y, m_nPrecision);
+      *pDst++ = ' ';
+      pDst = appendFixed(pDst, pt.z, m_nPrecision);
+      *pDst++ = '\x0D';
+      *pDst++ = '\x0A';
+      return pDst;
+    }
 
-      str.format("         vertex %ls %ls %ls\x0D\x0A", odDToStr(dfix(cell.p1.x), 'f', 6).c_str(), odDToStr(dfix(cell.p1.y), 'f', 6).c_str(), odDToStr(dfix(cell.p1.z), 'f', 6).c_str());
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
-      str.format("         vertex %ls %ls %ls\x0D\x0A", odDToStr(dfix(cell.p2.x), 'f', 6).c_str(), odDToStr(dfix(cell.p2.y), 'f', 6).c_str(), odDToStr(dfix(cell.p2.z), 'f', 6).c_str());
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
-      str.format("         vertex %ls %ls %ls\x0D\x0A", odDToStr(dfix(cell.p3.x), 'f', 6).c_str(), odDToStr(dfix(cell.p3.y), 'f', 6).c_str(), odDToStr(dfix(cell.p3.z), 'f', 6).c_str());
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
+    void flushBlock()
+    {
+      if (m_nBlockUsed)
+      {
+        m_pOutStream->putBytes(m_block.asArrayPtr(), m_nBlockUsed);
+        m_nBlockUsed = 0;
+      }
+    }
 
-      str = "      endloop\x0D\x0A";
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
-      str = "   endfacet\x0D\x0A";
-      m_pOutStream->putBytes(str.c_str(), str.getLength());
+  protected:
+
+    virtual void triangleOut(const TriangleInfo &cell)
+    {
+      if (m_nBlockUsed + kMaxFacetChars > kBlockSize)
+        flushBlock();
+      char *pStart = (char*)m_block.asArrayPtr() + m_nBlockUsed;
+      char *pDst = appendText(pStart, "   facet normal ");
+      pDst = appendPoint(pDst, cell.normal);
+      pDst = appendText(pDst, "      outer loop\x0D\x0A         vertex ");
+      pDst = appendPoint(pDst, cell.p1);
+      pDst = appendText(pDst, "         vertex ");
+      pDst = appendPoint(pDst, cell.p2);
+      pDst = appendText(pDst, "         vertex ");
+      pDst = appendPoint(pDst, cell.p3);
+      pDst = appendText(pDst, "      endloop\x0D\x0A   endfacet\x0D\x0A");
+      m_nBlockUsed += OdUInt32(pDst - pStart);
     }
 
   public:
     OdSTLOutText()
       : OdSTLOutBase()
+      , m_nPrecision(6)
+      , m_nBlockUsed(0)
+    {
+    }
+
+    // number of decimals written for coordinates and normals, 0..9
+    void setPrecision(int nPrecision)
     {
+      m_nPrecision = odmax(0, odmin(nPrecision, 9));
     }
 
     virtual void start() 
     {
+      m_block.resize(kBlockSize);
+      m_nBlockUsed = 0;
       OdAnsiString str = "solid ODA StlExport\x0D\x0A";
       m_pOutStream->putBytes(str.c_str(), str.getLength());
     }
 
+    virtual bool setStreamed(const OdGeExtents3d &extents)
+    {
+      // facets can't be reoriented in place in ASCII output
+      if (fCorrectSolid)
+        return false;
+      return OdSTLOutBase::setStreamed(extents);
+    }
+
     virtual void finish() 
     {
       OdSTLOutBase::finish();
+      flushBlock();
       OdAnsiString str = "endsolid ODA StlExport\x0D\x0A";
       m_pOutStream->putBytes(str.c_str(), str.getLength());
     }
@@ -435,42 +1001,100 @@ namespace TD_STL_EXPORT
 
   class OdSTLOutBinary : public OdSTLOutBase
   {
+    enum { kRecordSize = OdSTLBinaryRecordBlock::kRecordSize };
+
+    OdUInt64 m_nCountPos;
+    OdSTLBinaryRecordBlock m_block; // triangle records not yet passed to the stream
+
+    // flips orientation of the triangles already written by streamed export
+    void reorderWritten()
+    {
+      const OdUInt32 nChunk = 1024;
+      OdUInt8Array buf;
+      buf.resize(nChunk * kRecordSize);
+      const OdUInt64 nFirstRecord = m_nCountPos + 4;
+      for (OdUInt32 nDone = 0; nDone < m_nTriangles; )
+      {
+        OdUInt32 nRecords = odmin(nChunk, m_nTriangles - nDone);
+        OdUInt64 nPos = nFirstRecord + OdUInt64(nDone) * kRecordSize;
+        m_pOutStream->seek(nPos, OdDb::kSeekFromStart);
+        m_pOutStream->getBytes(buf.asArrayPtr(), nRecords * kRecordSize);
+        for (OdUInt32 n = 0; n < nRecords; ++n)
+        {
+          TriangleInfo cell;
+          ::memcpy(&cell, buf.asArrayPtr() + n * kRecordSize, sizeof(Od3Float) * 4);
+          cell.flip();
+          ::memcpy(buf.asArrayPtr() + n * kRecordSize, &cell, sizeof(Od3Float) * 4);
+        }
+        m_pOutStream->seek(nPos, OdDb::kSeekFromStart);
+        m_pOutStream->putBytes(buf.asArrayPtr(), nRecords * kRecordSize);
+        nDone += nRecords;
+      }
+    }
+
   protected:
     virtual void triangleOut(const TriangleInfo &cell)
     {
-      m_pOutStream->putBytes(&cell.normal, 12);
-      m_pOutStream->putBytes(&cell.p1, 12);
-      m_pOutStream->putBytes(&cell.p2, 12);
-      m_pOutStream->putBytes(&cell.p3, 12);
-      OdPlatformStreamer::wrInt16(*m_pOutStream, 0);
+      m_block.add(&cell.normal.x, *m_pOutStream);
     }
 
   public:
     OdSTLOutBinary( )
+      : m_nCountPos(0)
     {
     }
 
     virtual void start() 
     {
+      m_block.reset();
       OdAnsiString str(' ', 80);
       m_pOutStream->putBytes(str.c_str(), 80);
+      if (m_bStreamed)
+      {
+        // count is unknown yet, patched in finish()
+        m_nCountPos = m_pOutStream->tell();
+        OdPlatformStreamer::wrInt32(*m_pOutStream, 0);
+      }
     }
 
     virtual void finish() 
     {
+      if (m_bStreamed)
+      {
+        m_block.flush(*m_pOutStream);
+        OdSTLOutBase::finish();
+        OdUInt64 nEndPos = m_pOutStream->tell();
+        if (fCorrectSolid && m_SolidCheck.needsReorder())
+          reorderWritten();
+        m_pOutStream->seek(m_nCountPos, OdDb::kSeekFromStart);
+        OdPlatformStreamer::wrInt32(*m_pOutStream, m_nTriangles);
+        m_pOutStream->seek(nEndPos, OdDb::kSeekFromStart);
+        return;
+      }
       OdPlatformStreamer::wrInt32(*m_pOutStream, m_Data.size());
       OdSTLOutBase::finish();
+      m_block.flush(*m_pOutStream);
     }
   };
 
   class StubDeviceModuleText : public OdGsBaseModule
   {
     OdStreamBuf *m_pOutStream;
+    int m_nPrecision;
   public:
+    StubDeviceModuleText()
+      : m_pOutStream(0)
+      , m_nPrecision(6)
+    {
+    }
     void setStream(OdStreamBuf *pOutStream) 
     {
       m_pOutStream = pOutStream;
     }
+    void setPrecision(int nPrecision)
+    {
+      m_nPrecision = nPrecision;
+    }
   protected:
     OdSmartPtr<OdGsBaseVectorizeDevice> createDeviceObject()
     {
@@ -480,6 +1104,7 @@ namespace TD_STL_EXPORT
     {
       OdSmartPtr<OdGsViewImpl> pP = OdRxObjectImpl<OdSTLOutText, OdGsViewImpl>::createObject();
       ((OdSTLOutText*)pP.get())->setStream(m_pOutStream);
+      ((OdSTLOutText*)pP.get())->setPrecision(m_nPrecision);
       return pP;
     }
     OdSmartPtr<OdGsBaseVectorizeDevice> createBitmapDeviceObject()
@@ -530,15 +1155,15 @@ namespace TD_STL_EXPORT
     virtual ~TryToVectorizeMod() { }
 
     virtual void modifyContext(OdGiDefaultContextPtr &pCtx) const;
-    virtual void initDevice(OdGiDrawable* pEntity, OdDbBaseDatabase *pDb, OdGsDevicePtr &pDevice, OdGiDefaultContextPtr pCtx, double dDeviation, bool fCorrectSolids) const;
+    virtual void initDevice(OdGiDrawable* pEntity, OdDbBaseDatabase *pDb, OdGsDevicePtr &pDevice, OdGiDefaultContextPtr pCtx, double dDeviation, bool fCorrectSolids, bool bStreamed) const;
     virtual void vectorizationTest(OdGsDevicePtr pDevice) const;
   };
 
-  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, const TryToVectorizeMod &pMod = TryToVectorizeMod());
+  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool bStreamed, int nTextPrecision, OdGePoint3dArray *pInvalidEdges, const TryToVectorizeMod &pMod = TryToVectorizeMod());
 
   void TryToVectorizeMod::modifyContext(OdGiDefaultContextPtr &/*pCtx*/) const { }
   
-  void TryToVectorizeMod::initDevice(OdGiDrawable* pEntity, OdDbBaseDatabase *pDb, OdGsDevicePtr &pDevice, OdGiDefaultContextPtr pCtx, double dDeviation, bool fCorrectSolids) const
+  void TryToVectorizeMod::initDevice(OdGiDrawable* pEntity, OdDbBaseDatabase *pDb, OdGsDevicePtr &pDevice, OdGiDefaultContextPtr pCtx, double dDeviation, bool fCorrectSolids, bool bStreamed) const
   {
     OdGsViewPtr pNewView = pDevice->createView();
 
@@ -547,6 +1172,8 @@ namespace TD_STL_EXPORT
     OdGeExtents3d extents;
     pEntity->getGeomExtents(extents);
     ((StubVectorizeView*)pNewView.get())->setEpsilon(std::numeric_limits<float>::epsilon() * extents.minPoint().distanceTo(extents.maxPoint()));
+    if (bStreamed)
+      ((OdSTLOutBase*)pNewView.get())->setStreamed(extents);
 
     pNewView->setMode(OdGsView::kFlatShaded);
     ((OdSTLOutBinary*)pNewView.get())->setDeviation(dDeviation);
@@ -568,14 +1195,17 @@ namespace TD_STL_EXPORT
     pDevice->update();
   }
 
-  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, const TryToVectorizeMod &pMod)
+  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool bStreamed, int nTextPrecision, OdGePoint3dArray *pInvalidEdges, const TryToVectorizeMod &pMod)
   {
     odgsInitialize();
     OdGsModulePtr pGsModule = bTextMode ? ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleText)(OD_T("StubDeviceModuleText"))
                                         : ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleBinary)(OD_T("StubDeviceModuleBinary"));
 
     if (bTextMode)
+    {
       ((StubDeviceModuleText*)pGsModule.get())->setStream(&pOutStream);
+      ((StubDeviceModuleText*)pGsModule.get())->setPrecision(nTextPrecision);
+    }
     else
       ((StubDeviceModuleBinary*)pGsModule.get())->setStream(&pOutStream);
 
@@ -585,7 +1215,12 @@ namespace TD_STL_EXPORT
     //pContext->setDatabase(pDb);
     //pContext->enableGsModel(bGsModelEnable);
     pMod.modifyContext(pContext);
-    pMod.initDevice(&pEntity, pDb, pDevice, pContext, dDeviation, fCorrectSolids);
+    pMod.initDevice(&pEntity, pDb, pDevice, pContext, dDeviation, fCorrectSolids, bStreamed);
+    if (pInvalidEdges)
+    {
+      for (int nView = 0; nView < pDevice->numViews(); ++nView)
+        ((OdSTLOutBase*)pDevice->viewAt(nView))->setInvalidEdges(pInvalidEdges);
+    }
 
     OdGsDCRect screenRect(OdGsDCPoint(0, 1000), OdGsDCPoint(1000, 0));
     pDevice->onSize(screenRect);
@@ -596,18 +1231,18 @@ namespace TD_STL_EXPORT
     odgsUninitialize();
   }
 
-  OdResult doExport(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool fCorrectSolid)
+  OdResult doExport(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool fCorrectSolid, bool bStreamed, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
   {
     OdResult ret = eOk;
     try
     {
       if (bTextMode)
       {
-        tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, true, dDeviation, fCorrectSolid);
+        tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, true, dDeviation, fCorrectSolid, bStreamed, nTextPrecision, pInvalidEdges);
       }
       else
       {
-        tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, false, dDeviation, fCorrectSolid);
+        tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, false, dDeviation, fCorrectSolid, bStreamed, nTextPrecision, pInvalidEdges);
       }
     }
     catch (const OdError& e)
@@ -622,13 +1257,27 @@ namespace TD_STL_EXPORT
     return ret;
   }
 
-  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation)
+  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision)
+  {
+    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, false, false, nTextPrecision, 0);
+  }
+
+  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
+  {
+    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, true, false, nTextPrecision, pInvalidEdges);
+  }
+
+  OdResult exportSTLStreamed(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool bCorrectSolid, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
   {
-    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, false);
+    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, bCorrectSolid, true, nTextPrecision, pInvalidEdges);
   }
 
-  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation)
+  OdResult exportSTLToDescriptor(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, int nFileDescriptor, bool bTextMode, double dDeviation, bool bCorrectSolid, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
   {
-    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, true);
+    if (nFileDescriptor < 0)
+      return eInvalidInput;
+    OdStaticRxObject<OdSTLDescriptorStream> stream;
+    stream.setDescriptor(nFileDescriptor);
+    return doExport(pDb, pEntity, stream, bTextMode, dDeviation, bCorrectSolid, true, nTextPrecision, pInvalidEdges);
   }
 };
@@ -40,13 +40,23 @@ void STLModule::uninitApp()
 {
 }
 
-OdResult STLModule::exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation)
+OdResult STLModule::exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision)
 {
-  return TD_STL_EXPORT::exportSTL(pDb, pEntity, pOutStream, bTextMode, dDeviation);
+  return TD_STL_EXPORT::exportSTL(pDb, pEntity, pOutStream, bTextMode, dDeviation, nTextPrecision);
 }
 
-OdResult STLModule::exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation)
+OdResult STLModule::exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
 {
-  return TD_STL_EXPORT::exportSTLEx(pDb, pEntity, pOutStream, bTextMode, dDeviation);
+  return TD_STL_EXPORT::exportSTLEx(pDb, pEntity, pOutStream, bTextMode, dDeviation, nTextPrecision, pInvalidEdges);
+}
+
+OdResult STLModule::exportSTLStreamed(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool bCorrectSolid, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
+{
+  return TD_STL_EXPORT::exportSTLStreamed(pDb, pEntity, pOutStream, bTextMode, dDeviation, bCorrectSolid, nTextPrecision, pInvalidEdges);
+}
+
+OdResult STLModule::exportSTLToDescriptor(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, int nFileDescriptor, bool bTextMode, double dDeviation, bool bCorrectSolid, int nTextPrecision, OdGePoint3dArray *pInvalidEdges)
+{
+  return TD_STL_EXPORT::exportSTLToDescriptor(pDb, pEntity, nFileDescriptor, bTextMode, dDeviation, bCorrectSolid, nTextPrecision, pInvalidEdges);
 }
 }
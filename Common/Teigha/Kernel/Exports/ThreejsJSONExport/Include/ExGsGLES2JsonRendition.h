@@ -32,6 +32,8 @@
 #include "JsonServer.h"
 #include "ThreejsJSONExportDef.h"
 #include "JsonObjectFormat.h"
+#include "JsonMetafileConverter.h"
+#include "SharedPtr.h"
 
 #define OD_GLES2JSON_ENABLEPROGRAMDECISION
 
@@ -64,6 +66,17 @@ class THREEJSJSONEXPORT_DLL OdGLES2JsonRendition : public OdTrVisRenditionDef, p
     OdTrVisRenderClient *m_pProcDevice;
     // Overall viewport state
     OdTrVisViewportDef m_overallViewport;
+    // Metafiles parsed but not merged into m_pJsonObj yet. Filled under global Mt mutex,
+    // flushed from callbacks which aren't called from Mt.
+    struct PendingMetafile
+    {
+      OdSharedPtr<JsonMetafileConverter> m_pConverter;
+      OdTrVisMetafileContainerPtr m_pMetafile;
+      OdUInt64 m_regId;
+      OdUInt64 m_layerId;
+    };
+    OdArray<PendingMetafile> m_pendingMetafiles;
+    struct ConvertWorker;
   public:
     OdGLES2JsonRendition();
     ~OdGLES2JsonRendition();
@@ -88,7 +101,9 @@ class THREEJSJSONEXPORT_DLL OdGLES2JsonRendition : public OdTrVisRenditionDef, p
     void setGsUpdateMode();
     bool isIntermediateMode() const { return (m_mode == kIntermediate); }
     bool isGsUpdateMode() const { return (m_mode == kGsUpdate); }
-    void DropMetadata(const OdTrVisFlatMetafileContainer *pMetafile, const OdUInt64 &metafile_reg_id, const OdUInt64 &layer_id);
+    void DropMetadata(const OdTrVisMetafileContainerPtr &pMetafile, const OdUInt64 &metafile_reg_id, const OdUInt64 &layer_id);
+    // Converts pending metafiles (concurrently if ThreadPool is available) and merges them in order of adding
+    void flushPendingMetafiles();
 
     // High-level callbacks
 
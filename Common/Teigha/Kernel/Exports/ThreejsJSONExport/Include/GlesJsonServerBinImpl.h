@@ -0,0 +1,62 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2017, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2017 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+//
+// GlesJsonServerBinImpl.h
+//
+
+#ifndef OG_GLES_JSON_SERVER_BIN_IMPL_H_
+#define OG_GLES_JSON_SERVER_BIN_IMPL_H_
+
+#include "GlesJsonServerImpl.h"
+
+/** <group ExRender_Classes>
+  JSON server which keeps only the scene graph in JSON. Vertex, normal, color and
+  index arrays are appended as raw little-endian data to a side buffer, and the JSON
+  refers to them as {"buffer":name,"byteOffset":n,"byteLength":n,"componentType":type}.
+  Arrays are written straight from the caller's memory, without a formatting copy.
+*/
+class OdGlesJsonServerBinImpl : public OdGlesJsonServerImpl
+{
+  OdStreamBufPtr m_pBinStream;
+  OdAnsiString m_sBinName; // name of the side buffer as referenced from JSON (UTF-8, JSON escaped)
+
+public:
+  OdGlesJsonServerBinImpl(const OdDbBaseDatabase *pDb = NULL);
+
+  // set side buffer for array data and the name JSON refers to it by
+  void setBinaryOutput(OdStreamBuf * buf, const OdString& sBufferName);
+  // set output path name or format(if %d is present in path), side buffer is created as <path>.bin
+  virtual bool setOutPathName(const OdString& sPathName,
+                              OdUInt64 limitToSplit = OdUInt64(), // if > OdUInt64() then willbe splited by next OnStateChanged
+                              int indexNextFree = 0); 
+  virtual int flushOut(); // return next free index
+
+  virtual void DropInts(const char* pTagName, OdUInt32 nData, const OdUInt16* pData);
+  virtual void DropUInts(const char* pTagName, OdUInt32 nData, const OdUInt32* pData);
+  virtual void DropFloats(const char* pTagName, OdUInt32 nData, const float* pData);
+
+protected:
+  void dropBuffer(const char* pTagName, const void* pData, OdUInt32 nData, OdUInt32 nElemSize, const char* pComponentType);
+};
+
+#endif // OG_GLES_JSON_SERVER_BIN_IMPL_H_
@@ -34,6 +34,7 @@
 
 class OdTrVisFlatMetafileContainer;
 class JsonObjectFormat;
+class JsonInterjacentObject;
 
 /** \details
   <group Other_Classes>
@@ -123,8 +124,10 @@ public:
     , m_geometry_arrays()
     , m_objs()
     , m_weight()
+    , m_arena()
+    , m_bGeometriesConverted(false)
   {}
-  ~JsonMetafileConverter() {}
+  ~JsonMetafileConverter();
 
   void SetRGB(const ODCOLORREF &rgb) { m_rgb = rgb; }
   void SetMaterial(const OdUInt64 &material_id) { m_material_id = material_id; }
@@ -145,16 +148,49 @@ public:
   void AddLineStrip(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type = geometry, const OdUInt32 &ind = 0);
   void AddMesh(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type = geometry, const OdUInt32 &ind = 0);
 
+  // Extracts geometry buffers of all primitives from metafile arrays. Touches only this converter,
+  // so converters of different metafiles can run it concurrently.
+  void ConvertGeometries(const OdTrVisFlatMetafileContainer *pMetafile);
+  // Merges converted primitives into json_obj (converts geometries first if not done yet). Must be called serially.
   void AddObjectsByRootId(JsonObjectFormat *json_obj, const OdTrVisFlatMetafileContainer *pMetafile, const OdUInt64 &root_id, const OdUInt64 &layer_id);
 
+  OdUInt32 GetObjectsCount() const { return (OdUInt32)m_objs.size(); }
+
+  // Chunked storage of primitive objects, released at once together with converter
+  class Arena
+  {
+  public:
+    Arena() : m_chunks(), m_nUsed(kChunkSize) {}
+    ~Arena() { clear(); }
+
+    void *allocate(size_t nBytes);
+    void clear();
+
+  private:
+    enum { kChunkSize = 16384 };
+    std::vector<OdUInt8*> m_chunks;
+    size_t m_nUsed;
+
+    Arena(const Arena &);
+    Arena &operator =(const Arena &);
+  };
+
 private:
+  template <class TObject>
+  TObject *NewObject(const TObject &obj);
+
+  JsonMetafileConverter(const JsonMetafileConverter &);
+  JsonMetafileConverter &operator =(const JsonMetafileConverter &);
+
   ODCOLORREF m_rgb;
   OdUInt64 m_material_id;
   OdUInt32 m_faces_form;
   kGeomMarkerType m_geom_marker_type;
   std::map<OdUInt32, OdUInt8> m_geometry_arrays;
-  std::vector<OdRxObjectPtr> m_objs;
+  std::vector<JsonInterjacentObject*> m_objs;
   line_weight m_weight;
+  Arena m_arena;
+  bool m_bGeometriesConverted;
 };
 
 #endif // JSON_METAFILE_CONVERTER
@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2017, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2017 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+// Printf-free number formatting for GLES2 Json server
+
+#ifndef ODGLES2JSONNUMBERFORMAT
+#define ODGLES2JSONNUMBERFORMAT
+
+#include "OdaCommon.h"
+#include "OdAnsiString.h"
+#include <stdio.h>
+#include <string.h>
+
+/** \details
+    Formats numbers for Json output without going through printf.
+
+    \remarks
+    Float output is numerically identical to the historical "%f" (|value| in [0.1, 1e16))
+    and "%g" (other values) formatting with the same precision; only trailing zeros of
+    the fraction are dropped. Rounding is done on the exact binary value, half to even,
+    as printf does. Values whose exact rounding needs more than 64-bit integer or double
+    arithmetic (|value| < 1e-4 or >= 1e16) still go through printf.
+
+    <group ExRender_Classes> 
+*/
+class OdGLES2JsonNumberFormat
+{
+public:
+  enum
+  {
+    kMaxDecimals    = 9,  // maximum digits after the point in "%f" range
+    kMaxSignificant = 9,  // maximum significant digits in "%g" range
+    kMaxFloatChars  = 32, // enough for any float with maximum precision including sign and terminator
+    kMaxIntChars    = 24  // enough for any 64-bit integer including sign and terminator
+  };
+
+  static char *formatUInt(char *pBuf, OdUInt64 val)
+  {
+    char digits[kMaxIntChars];
+    char *pDigit = digits;
+    do
+    {
+      *pDigit++ = char('0' + val % 10);
+      val /= 10;
+    }
+    while (val);
+    while (pDigit != digits)
+      *pBuf++ = *--pDigit;
+    *pBuf = 0;
+    return pBuf;
+  }
+
+  static char *formatInt(char *pBuf, OdInt64 val)
+  {
+    if (val < 0)
+    {
+      *pBuf++ = '-';
+      return formatUInt(pBuf, OdUInt64(0) - OdUInt64(val));
+    }
+    return formatUInt(pBuf, OdUInt64(val));
+  }
+
+  // Writes nDecimals digits of fraction value without trailing zeros, with the point
+  static char *formatFraction(char *pBuf, OdUInt64 frac, int nDecimals)
+  {
+    if (!frac)
+      return pBuf;
+    while (!(frac % 10))
+    {
+      frac /= 10;
+      --nDecimals;
+    }
+    *pBuf++ = '.';
+    for (int i = nDecimals - 1; i >= 0; --i, frac /= 10)
+      pBuf[i] = char('0' + frac % 10);
+    pBuf += nDecimals;
+    *pBuf = 0;
+    return pBuf;
+  }
+
+  static char *formatFloat(char *pBuf, float val, int nDecimals = 6, int nSignificant = 6)
+  {
+    static const OdUInt64 pow10[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+                                      100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL };
+    nDecimals = odmax(0, odmin(nDecimals, int(kMaxDecimals)));
+    nSignificant = odmax(1, odmin(nSignificant, int(kMaxSignificant)));
+
+    if (val == 0.0f)
+    {
+      *pBuf++ = '0';
+      *pBuf = 0;
+      return pBuf;
+    }
+    float absVal = (val >= 0.0f) ? val : -val;
+    if (absVal >= 0.1f && absVal < 1e+16)
+    {
+      // "%f" range, val = mant * 2^exp exactly
+      OdUInt32 bits;
+      ::memcpy(&bits, &absVal, sizeof(bits));
+      OdUInt64 mant = (bits & 0x7FFFFF) | 0x800000;
+      int exp = int((bits >> 23) & 0xFF) - 150;
+
+      OdUInt64 intPart, frac = 0;
+      if (exp >= 0)
+        intPart = mant << exp;
+      else
+      {
+        // |val| >= 0.1 keeps the shift below 28 bits, mant * 10^9 fits 54 bits
+        OdUInt64 scaled = mant * pow10[nDecimals];
+        OdUInt64 q = scaled >> -exp, r = scaled & ((OdUInt64(1) << -exp) - 1), half = OdUInt64(1) << (-exp - 1);
+        if (r > half || (r == half && (q & 1)))
+          ++q;
+        intPart = q / pow10[nDecimals];
+        frac = q % pow10[nDecimals];
+      }
+      if (val < 0.0f)
+        *pBuf++ = '-';
+      pBuf = formatUInt(pBuf, intPart);
+      return formatFraction(pBuf, frac, nDecimals);
+    }
+    if (absVal < 0.1f && absVal >= 1e-4f)
+    {
+      // "%g" range without exponent: p digits after the point, p <= 12 so |val| * 10^p is exact in double
+      int p = nSignificant + 1;
+      double d = double(absVal) * double(pow10[p]);
+      while (d >= double(pow10[nSignificant]) && p > 0)
+        d = double(absVal) * double(pow10[--p]);
+      while (d < double(pow10[nSignificant - 1]) && p < 12)
+        d = double(absVal) * double(pow10[++p]);
+      OdUInt64 n = OdUInt64(d);
+      double diff = d - double(n);
+      if (diff > 0.5 || (diff == 0.5 && (n & 1)))
+        ++n;
+      if (n == pow10[nSignificant])
+      {
+        n /= 10;
+        --p;
+      }
+      if (nSignificant - 1 - p >= -4) // no exponent form
+      {
+        if (val < 0.0f)
+          *pBuf++ = '-';
+        *pBuf++ = '0';
+        *pBuf = 0;
+        return formatFraction(pBuf, n, p);
+      }
+    }
+#if defined(odSprintfA)
+    odSprintfA(pBuf, kMaxFloatChars, "%.*g", nSignificant, (double)val);
+#else
+    sprintf(pBuf, "%.*g", nSignificant, (double)val);
+#endif
+    return pBuf + ::strlen(pBuf);
+  }
+
+  /** \details
+    Appends pStr to str replacing '<', '>' and new line by XML entities in a single pass.
+  */
+  static void appendEscaped(OdAnsiString &str, const char *pStr)
+  {
+    int nLen = str.getLength(), nEscaped = 0;
+    const char *pCh;
+    for (pCh = pStr; *pCh; ++pCh)
+    {
+      if (*pCh == '<' || *pCh == '>')
+        nEscaped += 3;
+      else if (*pCh == '\n')
+        nEscaped += 5;
+    }
+    int nStrLen = int(pCh - pStr);
+    char *pDst = str.getBuffer(nLen + nStrLen + nEscaped + 1) + nLen;
+    for (pCh = pStr; *pCh; ++pCh)
+    {
+      switch (*pCh)
+      {
+      case '<':  ::memcpy(pDst, "&lt;", 4);   pDst += 4; break;
+      case '>':  ::memcpy(pDst, "&gt;", 4);   pDst += 4; break;
+      case '\n': ::memcpy(pDst, "&#x0A;", 6); pDst += 6; break;
+      default:   *pDst++ = *pCh;
+      }
+    }
+    *pDst = 0;
+    str.releaseBuffer(nLen + nStrLen + nEscaped);
+  }
+};
+
+#endif // ODGLES2JSONNUMBERFORMAT
@@ -27,6 +27,7 @@
 
 #include "OdString.h"
 #define STL_USING_LIST
+#define STL_USING_MAP
 #define STL_USING_ALGORITHM
 #include "OdaSTL.h"
 #include "JsonServer.h"
@@ -52,7 +53,7 @@ struct JsonMetadata
 /** \details
   <group !!RECORDS_tkernel_apiref>
 */
-struct JsonGeometriesDataBase : public OdRxObject
+struct JsonGeometriesDataBase
 {
   enum kDataType
   {
@@ -70,73 +71,89 @@ struct JsonGeometriesDataBase : public OdRxObject
     move_buffer
   };
 
-  JsonGeometriesDataBase() {}
-  JsonGeometriesDataBase(const OdUInt32 &size, const kDataType& data_type)
+  enum kElementType
+  {
+    float_element = 0,
+    uint32_element,
+    uint16_element
+  };
+
+  JsonGeometriesDataBase()
+    : m_size(0)
+    , m_data_type(normal)
+    , m_element_type(float_element)
+    , m_data(NULL)
+  {}
+  JsonGeometriesDataBase(const OdUInt32 &size, const kDataType& data_type, const kElementType &element_type)
     : m_size(size)
     , m_data_type(data_type)
+    , m_element_type(element_type)
+    , m_data(NULL)
   {}
-  virtual ~JsonGeometriesDataBase() {}
-
-  void addRef() { }
-  void release() { }
 
   const kDataType &GetDataType() const { return m_data_type; }
+  const kElementType &GetElementType() const { return m_element_type; }
   const OdUInt32 &GetSize() const { return m_size; }
 
-  ODRX_USING_HEAP_OPERATORS(OdRxObject);
+  template <typename T>
+  const T *GetArray() const { return (const T*)m_data; }
+
+  // Deletes owned buffer. Records are plain values, buffer is owned by JsonGeometries keeping the record.
+  void FreeData()
+  {
+    switch (m_element_type)
+    {
+      case float_element:  delete[] (float*)m_data;    break;
+      case uint32_element: delete[] (OdUInt32*)m_data; break;
+      case uint16_element: delete[] (OdUInt16*)m_data; break;
+    }
+    m_data = NULL;
+  }
 
 protected:
   OdUInt32 m_size;
   kDataType m_data_type;
+  kElementType m_element_type;
+  void *m_data;
 };
-typedef OdSmartPtr<JsonGeometriesDataBase> JsonGeometriesDataPtr;
 
 //JsonGeometries
 
+template <typename T> struct JsonGeometriesElementType;
+template <> struct JsonGeometriesElementType<float> { enum { value = JsonGeometriesDataBase::float_element }; };
+template <> struct JsonGeometriesElementType<OdUInt32> { enum { value = JsonGeometriesDataBase::uint32_element }; };
+template <> struct JsonGeometriesElementType<OdUInt16> { enum { value = JsonGeometriesDataBase::uint16_element }; };
+
 /** \details
+  Typed constructor of geometry data record. Takes ownership of moved buffer, copies buffer only by copy_buffer request.
   <group !!RECORDS_tkernel_apiref>
 */
 template <typename T>
 struct JsonGeometriesData : JsonGeometriesDataBase
 {
   JsonGeometriesData()
-    : data_array(NULL)
+    : JsonGeometriesDataBase(0, normal, (kElementType)JsonGeometriesElementType<T>::value)
   {}
-  JsonGeometriesData(const OdUInt32 &size, const void* source_array, const kDataType& data_type, const kBufferCopyType& copy_buffer_type)
-    : JsonGeometriesDataBase(size, data_type)
-    , data_array(NULL)
+  JsonGeometriesData(const OdUInt32 &size, const void* source_array, const kDataType& data_type, const kBufferCopyType& copy_buffer_type = move_buffer)
+    : JsonGeometriesDataBase(size, data_type, (kElementType)JsonGeometriesElementType<T>::value)
   {
     if (copy_buffer_type == JsonGeometriesDataBase::move_buffer)
-      data_array = (T*)source_array;
+      m_data = const_cast<void*>(source_array);
     else
     {
-      try
-      {
-        OdUInt32 nData = size / sizeof(T);
-        data_array = new T[nData];
-        memcpy((void*)data_array, source_array, size);
-      }
-      catch (...)
-      {
-        if (data_array != NULL)
-          delete data_array;
-        throw;
-      }
+      OdUInt32 nData = size / sizeof(T);
+      T *data_array = new T[nData];
+      memcpy((void*)data_array, source_array, size);
+      m_data = data_array;
     }
   }
 
-  virtual ~JsonGeometriesData()
-  {
-    delete[] data_array;
-  }
-
-  const T *GetArray() const { return data_array; }
-
-protected:
-  T* data_array;
+  const T *GetArray() const { return (const T*)m_data; }
 };
 
 /** \details
+  Attribute records are kept in one contiguous array per geometry. Geometries are copied as values into
+  JsonObjectFormat before any data is added, so buffers are freed by JsonObjectFormat through FreeData().
   <group !!RECORDS_tkernel_apiref>
 */
 struct JsonGeometries
@@ -147,6 +164,11 @@ struct JsonGeometries
     BufferGeometry
   };
 
+  enum
+  {
+    kDefAttributesCount = 4 // vertices, normals, colors and faces
+  };
+
   JsonGeometries()
     : m_type(Geometry)
     , m_data_attribute()
@@ -157,12 +179,23 @@ struct JsonGeometries
   {}
 
   const kGeometriesType &GetType() const { return m_type; }
-  OdUInt32 GetAttributeCount() const { return (OdUInt32)m_data_attribute.size(); }
+  OdUInt32 GetAttributeCount() const { return m_data_attribute.size(); }
 
   template <typename T>
-  void AddData(const OdUInt32 &size, const void* data, const JsonGeometriesDataBase::kDataType &data_type, const JsonGeometriesDataBase::kBufferCopyType &copy_type)
+  void AddData(const OdUInt32 &size, const void* data, const JsonGeometriesDataBase::kDataType &data_type, const JsonGeometriesDataBase::kBufferCopyType &copy_type = JsonGeometriesDataBase::move_buffer)
   {
-    m_data_attribute.push_back(JsonGeometriesDataPtr(new JsonGeometriesData<T>(size, data, data_type, copy_type))); 
+    JsonGeometriesDataBase attr = JsonGeometriesData<T>(size, data, data_type, copy_type);
+    try
+    {
+      if (m_data_attribute.isEmpty())
+        m_data_attribute.reserve(kDefAttributesCount);
+      m_data_attribute.push_back(attr);
+    }
+    catch (...)
+    {
+      attr.FreeData();
+      throw;
+    }
   }
 
   template <typename T>
@@ -171,9 +204,16 @@ struct JsonGeometries
     std::for_each(m_data_attribute.begin(), m_data_attribute.end(), *obj);
   }
 
+  void FreeData()
+  {
+    for (OdUInt32 n = 0; n < m_data_attribute.size(); n++)
+      m_data_attribute[n].FreeData();
+    m_data_attribute.clear();
+  }
+
 protected:
   kGeometriesType m_type;
-  std::list<JsonGeometriesDataPtr> m_data_attribute;
+  OdArray<JsonGeometriesDataBase, OdMemoryAllocator<JsonGeometriesDataBase> > m_data_attribute;
 };
 
 //JsonMaterials
@@ -276,6 +316,52 @@ protected:
   OdArray<JsonMaterialColor> m_colors;
 };
 
+/** \details
+  Content of material generated for metafile primitives, used to write every distinct material once.
+  <group !!RECORDS_tkernel_apiref>
+*/
+struct JsonMaterialKey
+{
+  JsonMaterialKey(const JsonMaterials::kMaterialType &type, const OdUInt64 &copy_by_material_id, const ODCOLORREF &color)
+    : m_type(type)
+    , m_copy_by_material_id(copy_by_material_id)
+    , m_color(color)
+    , m_weight_type(0xFF)
+    , m_weight_int(0)
+    , m_weight_double(0)
+  {}
+
+  void SetLineWeight(OdUInt8 weight_type, const OdInt16 &weight_int, const double &weight_double)
+  {
+    m_weight_type = weight_type;
+    m_weight_int = weight_int;
+    m_weight_double = weight_double;
+  }
+
+  bool operator <(const JsonMaterialKey &o) const
+  {
+    if (m_type != o.m_type)
+      return m_type < o.m_type;
+    if (m_copy_by_material_id != o.m_copy_by_material_id)
+      return m_copy_by_material_id < o.m_copy_by_material_id;
+    if (m_color != o.m_color)
+      return m_color < o.m_color;
+    if (m_weight_type != o.m_weight_type)
+      return m_weight_type < o.m_weight_type;
+    if (m_weight_int != o.m_weight_int)
+      return m_weight_int < o.m_weight_int;
+    return m_weight_double < o.m_weight_double;
+  }
+
+protected:
+  JsonMaterials::kMaterialType m_type;
+  OdUInt64 m_copy_by_material_id;
+  ODCOLORREF m_color;
+  OdUInt8 m_weight_type;
+  OdInt16 m_weight_int;
+  double m_weight_double;
+};
+
 //JsonObject
 
 /** \details
@@ -380,6 +466,7 @@ public:
     : m_metadata()
     , m_geometries()
     , m_materials()
+    , m_material_keys()
     , m_objects()
     , m_scene_uuid(GetNewObjectUUID())
     , m_camera_options(NULL)
@@ -402,6 +489,9 @@ public:
   }
   virtual ~JsonObjectFormat() 
   {
+    std::map<OdUInt64, JsonGeometries>::iterator pGeom = m_geometries.begin();
+    for (; pGeom != m_geometries.end(); ++pGeom)
+      pGeom->second.FreeData();
     if (m_camera_options != NULL)
       delete m_camera_options;
   }
@@ -437,13 +527,18 @@ public:
   OdBool AddMaterialColor(const OdUInt64& id, const JsonMaterialColor::kColorType &type, const ODCOLORREF &color);
   OdBool AddMaterialWidth(const OdUInt64& id, float w);
   OdUInt64 CopyMaterial(const OdUInt64& id, const JsonMaterials::kMaterialType &new_type);
+  // Returns id of material added with the same content before, or 0
+  OdUInt64 FindMaterialByKey(const JsonMaterialKey &key) const;
+  void AddMaterialKey(const JsonMaterialKey &key, const OdUInt64 &id);
+  OdUInt32 GetMaterialsCount() const { return (OdUInt32)m_materials.size(); }
 
   void AddMaterialLenWeightIndx(const OdUInt64 &mat_id, const OdInt16 &lens_ind);
   void AddMaterialLenWeight(const OdUInt64 &mat_id, const double &len_weight);
 
   void AddGeometries(const OdUInt64 &uuid, const JsonGeometries::kGeometriesType &type);
+  // With move_buffer data ownership is taken only if geometry exists (true returned)
   template <typename T>
-  OdBool AddGeometriesData(const OdUInt64& uuid, OdUInt32 size, const void* data, const JsonGeometriesDataBase::kDataType &data_type, const JsonGeometriesDataBase::kBufferCopyType &copy_type = JsonGeometriesDataBase::copy_buffer)
+  OdBool AddGeometriesData(const OdUInt64& uuid, OdUInt32 size, const void* data, const JsonGeometriesDataBase::kDataType &data_type, const JsonGeometriesDataBase::kBufferCopyType &copy_type = JsonGeometriesDataBase::move_buffer)
   {
     JsonGeometries *const g = GetGeomertry(uuid);
     if (g != NULL)
@@ -489,6 +584,7 @@ private:
   JsonMetadata m_metadata;
   std::map<OdUInt64, JsonGeometries> m_geometries;
   std::map<OdUInt64, JsonMaterials> m_materials;
+  std::map<JsonMaterialKey, OdUInt64> m_material_keys;
   std::map<OdUInt64, JsonObjectDataPtr> m_objects;
   OdUInt64 m_scene_uuid;
   CameraViewOptions *m_camera_options;
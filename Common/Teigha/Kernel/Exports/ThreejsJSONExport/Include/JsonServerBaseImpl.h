@@ -28,6 +28,7 @@
 #include "TD_PackPush.h"
 
 #include "JsonServer.h"
+#include "JsonNumberFormat.h"
 #include "Tr/TrVisUniqueId.h"
 #include "DbBaseDatabase.h"
 
@@ -95,8 +96,33 @@ protected:
         ); \
       } \
     }
-#   define ODFLTFMT(cstrpref, val, cstrsfx) \
-      ((val >= 0.0f ? val : - val) >= 0.1f && (val >= 0.0f ? val : - val) < 1e+16) ? cstrpref "%f" cstrsfx : cstrpref "%g" cstrsfx
+
+  int m_nFloatDecimals;    // digits after the point for |value| in [0.1, 1e16)
+  int m_nFloatSignificant; // significant digits for other values
+
+  // Writes floats separated by pSep into m_sTmpBuf, subtracting pOffs[index % 3] if set
+  void formatFloats(const float *pData, OdUInt32 nData, const char *pSep, const float *pOffs = NULL)
+  {
+    const int lenSep = (int)odStrLenA(pSep);
+    char *pBuf = m_sTmpBuf.getBuffer((int)nData * (OdGLES2JsonNumberFormat::kMaxFloatChars + lenSep) + 1), *pCur = pBuf;
+    for (OdUInt32 index = 0; index < nData; index++)
+    {
+      if (index)
+      {
+        ::memcpy(pCur, pSep, lenSep);
+        pCur += lenSep;
+      }
+      float val = pOffs ? pData[index] - pOffs[index % 3] : pData[index];
+      pCur = OdGLES2JsonNumberFormat::formatFloat(pCur, val, m_nFloatDecimals, m_nFloatSignificant);
+    }
+    *pCur = 0;
+    m_sTmpBuf.releaseBuffer((int)(pCur - pBuf));
+  }
+  void formatUInt(OdUInt64 data)
+  {
+    char *pBuf = m_sTmpBuf.getBuffer(OdGLES2JsonNumberFormat::kMaxIntChars);
+    m_sTmpBuf.releaseBuffer((int)(OdGLES2JsonNumberFormat::formatUInt(pBuf, data) - pBuf));
+  }
 
 public:
   OdGLES2JsonServerBaseImpl(const OdDbBaseDatabase *pDb = NULL)
@@ -107,6 +133,8 @@ public:
     , m_lenTmpBuf(0)
     , m_bEmptyMetaFile(true)
     , m_bEnableFaces(true)
+    , m_nFloatDecimals(6)
+    , m_nFloatSignificant(6)
   {
     setDatabase(pDb);
   }
@@ -123,6 +151,21 @@ public:
       m_pDbPE = NULL;
   }
 
+  // Sets float output precision (the defaults 6 and 6 match "%f" and "%g")
+  void setFloatPrecision(int nDecimals, int nSignificant)
+  {
+    m_nFloatDecimals = odmax(0, odmin(nDecimals, (int)OdGLES2JsonNumberFormat::kMaxDecimals));
+    m_nFloatSignificant = odmax(1, odmin(nSignificant, (int)OdGLES2JsonNumberFormat::kMaxSignificant));
+  }
+  int floatDecimals() const
+  {
+    return m_nFloatDecimals;
+  }
+  int floatSignificant() const
+  {
+    return m_nFloatSignificant;
+  }
+
   void setEnableFaces(OdBool enable) 
   {
     m_bEnableFaces = enable;
@@ -191,51 +234,54 @@ public:
   }
   virtual void DropUInt32(const char* pTagName, OdUInt32 data)
   {
-    ODFMTBEG(16)
-      "%u", (unsigned)data
-    ODFMTEND()
+    formatUInt(data);
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kNumber);
   }
   virtual void DropUInt64(const char* pTagName, OdUInt64 data)
   {
-    ODFMTBEG(32)
-      PRIu64, data
-    ODFMTEND()
+    formatUInt(data);
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kNumber);
   }
   virtual void DropInt32(const char* pTagName, OdInt32 data)
   {
-    ODFMTBEG(10)
-      "%d", (int)data
-    ODFMTEND()
+    char *pBuf = m_sTmpBuf.getBuffer(OdGLES2JsonNumberFormat::kMaxIntChars);
+    m_sTmpBuf.releaseBuffer((int)(OdGLES2JsonNumberFormat::formatInt(pBuf, data) - pBuf));
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kNumber);
   }
 
   virtual void DropChars(const char* pTagName, const char *pStr)
   {
-    m_sTmpBuf = pStr;
-    m_sTmpBuf.replace("<", "&lt;");
-    m_sTmpBuf.replace(">", "&gt;");
-    m_sTmpBuf.replace("\n", "&#x0A;");
+    m_sTmpBuf.empty();
+    OdGLES2JsonNumberFormat::appendEscaped(m_sTmpBuf, pStr);
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kString);
   }
 
   virtual void DropInts(const char* pTagName, OdUInt32 nData, const OdUInt16* pData)
   {
     ODA_ASSERT_ONCE(nData && pData);
-    ODFMTFORBEG(16)
-      index ? ",%d" : "%d" , pData[index]
-    ODFMTEND()
+    char *pBuf = m_sTmpBuf.getBuffer((int)nData * 6 + 1), *pCur = pBuf;
+    for (OdUInt32 index = 0; index < nData; index++)
+    {
+      if (index)
+        *pCur++ = ',';
+      pCur = OdGLES2JsonNumberFormat::formatUInt(pCur, pData[index]);
+    }
+    m_sTmpBuf.releaseBuffer((int)(pCur - pBuf));
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
 
   virtual void DropUInts(const char* pTagName, OdUInt32 nData, const OdUInt32* pData)
   {
     ODA_ASSERT_ONCE(nData && pData);
-    ODFMTFORBEG(32)
-      index ? ",%u" : "%u", pData[index]
-      ODFMTEND()		
-      ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
+    char *pBuf = m_sTmpBuf.getBuffer((int)nData * 11 + 1), *pCur = pBuf;
+    for (OdUInt32 index = 0; index < nData; index++)
+    {
+      if (index)
+        *pCur++ = ',';
+      pCur = OdGLES2JsonNumberFormat::formatUInt(pCur, pData[index]);
+    }
+    m_sTmpBuf.releaseBuffer((int)(pCur - pBuf));
+    ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
 
   virtual void DropFloats(const char* pTagName, OdUInt32 nData, const float *pData)
@@ -246,14 +292,12 @@ public:
         || (odabs(pData[0]) < 10000 && odabs(pData[1]) < 10000 && odabs(pData[2]) < 10000))
     {
       ODA_ASSERT_ONCE(nData && pData);
-      ODFMTFORBEG(32)
-        ODFLTFMT("%s", pData[index], ), index ? "," : "", pData[index]
-      ODFMTEND()
+      formatFloats(pData, nData, ",");
       ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
       return;
     }
 
-    float val, offs[3];
+    float offs[3];
    #if !defined(__BORLANDC__) && !defined(__hpux)
     offs[0] = ceilf(pData[0]) - 1.0f; offs[1] = ceilf(pData[1]) - 1.0f; offs[2] = ceilf(pData[2]) - 1.0f; // by first
    #else
@@ -264,56 +308,32 @@ public:
     DropFloat3("ArrayOffset", offs[0], offs[1], offs[2]);
 
     ODA_ASSERT_ONCE(nData && pData);
-    ODFMTFORBEGEX(16, val = pData[index] - offs[index % 3])
-      //index ? ",%g" : "%g" , pData[index] - offs[index % 3]
-      ODFLTFMT("%s", val, ), index ? "," : "", val
-    ODFMTEND()
+    formatFloats(pData, nData, ",", offs);
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kType);
   }
 
   virtual void DropFloat(const char* pTagName, float data)
   {
-    ODFMTBEG(32)
-      //"%g", data
-      ODFLTFMT( , data, ), data
-    ODFMTEND()
+    formatFloats(&data, 1, "");
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kNumber);
   }
 
   virtual void DropFloat2(const char* pTagName, float data1, float data2)
   {
-    ODFMTBEG(64)
-      //"%g, %g", data1, data2
-      ODFLTFMT(    , data1, ), data1
-    ODFMTADD()
-      ODFLTFMT(", ", data2, ), data2
-    ODFMTEND()
+    const float data[2] = { data1, data2 };
+    formatFloats(data, 2, ", ");
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
   virtual void DropFloat3(const char* pTagName, float data1, float data2, float data3)
   {
-    ODFMTBEG(96)
-      //"%g, %g, %g", data1, data2, data3
-      ODFLTFMT(    , data1, ), data1
-    ODFMTADD()
-      ODFLTFMT(", ", data2, ), data2
-    ODFMTADD()
-      ODFLTFMT(", ", data3, ), data3
-    ODFMTEND()
+    const float data[3] = { data1, data2, data3 };
+    formatFloats(data, 3, ", ");
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
   virtual void DropFloat4(const char* pTagName, float data1, float data2, float data3, float data4)
   {
-    ODFMTBEG(128)
-      //"%g, %g, %g, %g", data1, data2, data3, data4
-      ODFLTFMT(    , data1, ), data1
-    ODFMTADD()
-      ODFLTFMT(", ", data2, ), data2
-    ODFMTADD()
-      ODFLTFMT(", ", data3, ), data3
-    ODFMTADD()
-      ODFLTFMT(", ", data4, ), data4
-    ODFMTEND()
+    const float data[4] = { data1, data2, data3, data4 };
+    formatFloats(data, 4, ", ");
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
 
@@ -327,52 +347,25 @@ public:
 
   virtual void DropMatrix(const char* pTagName, const OdGeMatrix3d &data)
   {
-    ODFMTBEG(512)
-      //"%g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g",
-      //data.entry[0][0], data.entry[0][1], data.entry[0][2], data.entry[0][3],
-      //data.entry[1][0], data.entry[1][1], data.entry[1][2], data.entry[1][3],
-      //data.entry[2][0], data.entry[2][1], data.entry[2][2], data.entry[2][3],
-      //data.entry[3][0], data.entry[3][1], data.entry[3][2], data.entry[3][3]
-      ODFLTFMT(    , data.entry[0][0], ), (double)(float) data.entry[0][0]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[0][1], ), (double)(float) data.entry[0][1]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[0][2], ), (double)(float) data.entry[0][2]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[0][3], ), (double)(float) data.entry[0][3]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[1][0], ), (double)(float) data.entry[1][0]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[1][1], ), (double)(float) data.entry[1][1]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[1][2], ), (double)(float) data.entry[1][2]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[1][3], ), (double)(float) data.entry[1][3]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[2][0], ), (double)(float) data.entry[2][0]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[2][1], ), (double)(float) data.entry[2][1]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[2][2], ), (double)(float) data.entry[2][2]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[2][3], ), (double)(float) data.entry[2][3]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[3][0], ), (double)(float) data.entry[3][0]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[3][1], ), (double)(float) data.entry[3][1]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[3][2], ), (double)(float) data.entry[3][2]
-    ODFMTADD()
-      ODFLTFMT(", ", data.entry[3][3], ), (double)(float) data.entry[3][3]
-    ODFMTEND()
+    float entries[16];
+    for (int nRow = 0; nRow < 4; nRow++)
+      for (int nCol = 0; nCol < 4; nCol++)
+        entries[nRow * 4 + nCol] = (float)data.entry[nRow][nCol];
+    formatFloats(entries, 16, ", ");
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kArray);
   }
 
   virtual void DropBinaryStream(const char* pTagName, const OdUInt8 * pData, OdUInt32 nData)
   {
-    ODFMTFORBEG(4)
-      "%02X", pData[index]
-    ODFMTEND()
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char *pBuf = m_sTmpBuf.getBuffer((int)nData * 2 + 1);
+    for (OdUInt32 index = 0; index < nData; index++)
+    {
+      pBuf[index * 2] = hexDigits[pData[index] >> 4];
+      pBuf[index * 2 + 1] = hexDigits[pData[index] & 0x0F];
+    }
+    pBuf[nData * 2] = 0;
+    m_sTmpBuf.releaseBuffer((int)nData * 2);
     ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kType);
   }
 
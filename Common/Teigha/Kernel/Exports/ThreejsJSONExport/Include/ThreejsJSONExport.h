@@ -53,6 +53,20 @@ namespace TD_THREEJSJSON_EXPORT
   */
   OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled = false);
 
+  /** \details
+     Exports an element to ThreejsJSON file with geometry arrays moved to a binary buffer
+     
+     Input : background - color of scene background
+             bFacesEnabled - if true, export to JSON with faces, else - with lines and points
+             sBufferName - name the JSON refers to the buffer by (usually its file name)
+     Output: pOutStream - output stream for the JSON scene graph
+             pBufferStream - output stream for raw little-endian vertex, normal, color and index arrays
+    
+     Return : eOk is ok
+              or OdResult error code
+  */
+  OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, OdStreamBuf *pBufferStream, const OdString &sBufferName, const ODCOLORREF &background, bool bFacesEnabled = false);
+
 };
 
 #endif // _THREEJSJSON_EXPORT_INCLUDED_
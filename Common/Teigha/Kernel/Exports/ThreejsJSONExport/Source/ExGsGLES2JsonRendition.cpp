@@ -27,6 +27,10 @@
 #include "ExGsGLES2JsonSharingProvider.h"
 #include "ExGsGLES2JsonRendition.h"
 #include "JsonMetafileConverter.h"
+#include "RxThreadPoolLoop.h"
+#include "RxObjectImpl.h"
+#include "DynamicLinker.h"
+#include "OdModuleNames.h"
 
 #define OD_GLES2JSON_DROPHLTASCLIENTONLY
 
@@ -91,6 +95,8 @@ OdGLES2JsonRendition::OdGLES2JsonRendition()
 OdGLES2JsonRendition::~OdGLES2JsonRendition()
 {
   finalizeJsonServerUsage();
+  m_pendingMetafiles.clear();
+  delete m_pJsonObj.detach(); // JsonObjectFormat isn't reference counted
 }
 
 OdIntPtr OdGLES2JsonRendition::getClientSettings() const
@@ -205,6 +211,7 @@ void OdGLES2JsonRendition::finalizeJsonServerUsage()
   if (m_pRedir && m_pJson.get())
   {
     m_pRedir->dropRecords(); // ???
+    flushPendingMetafiles();
     m_idReg.traverse(this);
     m_idReg.killAll();
   }
@@ -229,6 +236,7 @@ void OdGLES2JsonRendition::onDeviceUpdateEnd(OdTrVisRenderClient *pDevice)
 {
   setIntermediateMode();
   OutputState(OdGLES2JsonServer::kIntermediateState);  
+  flushPendingMetafiles();
   json_obj()->DropObject();
 
   endDeviceProcessing(pDevice);
@@ -403,6 +411,7 @@ void OdGLES2JsonRendition::onOverlayRenderOrderChanged(OdTrVisOverlayId overlayI
 void OdGLES2JsonRendition::onViewportAdded(OdTrVisViewportId viewportId/*, const OdTrVisViewportDef &pDef*/)
 {
   JSON_REGISTER(kViewportData, viewportId);
+  flushPendingMetafiles();
   json_obj()->SetCameraMetafileMode();
 }
 
@@ -432,6 +441,7 @@ void OdGLES2JsonRendition::DropViewParams(JsonObjectFormat *pJsonObj, const OdTr
 void OdGLES2JsonRendition::onViewportModified(OdTrVisViewportId viewportId, const OdTrVisViewportDef &pDef, OdUInt32 kindOfMod)
 {
   JSON_REGISTERED(kViewportData, viewportId);//
+  flushPendingMetafiles();
  
   if (GETBIT(kindOfMod, kViewportModOrientation))
   {
@@ -453,6 +463,7 @@ void OdGLES2JsonRendition::onMetafileOrderChanged(OdTrVisViewportId viewportId,
 
 bool OdGLES2JsonRendition::DropDisplayList(const OdTrVisDisplayId *pDispList, OdUInt32 nListLen, const OdTrVisId &ViewPortId, DDL2ndPassInfo *p2ndPass)
 { 
+  flushPendingMetafiles();
   for (OdUInt32 n = 0; n < nListLen; n++)
   {
     ODA_ASSERT(pDispList[n] >= kDisplayCodeRange);
@@ -554,7 +565,7 @@ OdTrVisDisplayId OdGLES2JsonRendition::onMetafileAdded(OdTrVisMetafileId metafil
   {
     if (!json()->DropMetafileAdded(*this, metafileId, pDef))
     {
-      DropMetadata(pDef.m_pMetafile.get(), _jsonReg.m_resId, pDef.m_pMetafile->m_pLayer);
+      DropMetadata(pDef.m_pMetafile, _jsonReg.m_resId, pDef.m_pMetafile->m_pLayer);
     }
 
 #ifdef OD_GLES2JSON_DROPHLTASCLIENTONLY
@@ -673,7 +684,7 @@ void OdGLES2JsonRendition::DropLayerProps(const OdTrVisLayerProps &pLayerProps)
 {
 }
 
-void OdGLES2JsonRendition::DropMetadata(const OdTrVisFlatMetafileContainer *pMetafile, const OdUInt64 &metafile_reg_id, const OdUInt64 &layer_id)
+void OdGLES2JsonRendition::DropMetadata(const OdTrVisMetafileContainerPtr &pMetafile, const OdUInt64 &metafile_reg_id, const OdUInt64 &layer_id)
 {
   OdUInt32 uSize = pMetafile->size();
   if (uSize == 0) return;
@@ -684,7 +695,8 @@ void OdGLES2JsonRendition::DropMetadata(const OdTrVisFlatMetafileContainer *pMet
   const OdUInt8 *pMemPtr = pMetafile->memoryPtr();
   const OdUInt8 *pMemPtrReadFor = pMemPtr + uSize; 
 
-  JsonMetafileConverter metafile_converter;
+  OdSharedPtr<JsonMetafileConverter> pConverter = new JsonMetafileConverter();
+  JsonMetafileConverter &metafile_converter = *pConverter;
 
   while (pMemPtr < pMemPtrReadFor)
   {
@@ -955,7 +967,45 @@ void OdGLES2JsonRendition::DropMetadata(const OdTrVisFlatMetafileContainer *pMet
     }
   }
 
-  metafile_converter.AddObjectsByRootId(json_obj(), pMetafile, metafile_reg_id, layer_id);
+  // Geometries are extracted later, together with other metafiles of this update
+  PendingMetafile &pending = *m_pendingMetafiles.append();
+  pending.m_pConverter = pConverter;
+  pending.m_pMetafile = pMetafile;
+  pending.m_regId = metafile_reg_id;
+  pending.m_layerId = layer_id;
+}
+
+// Converts geometries of a pending metafile.
+struct OdGLES2JsonRendition::ConvertWorker
+{
+  PendingMetafile *m_pPending;
+
+  void operator()(OdUInt32 nPending, OdUInt32 /*nThread*/)
+  {
+    m_pPending[nPending].m_pConverter->ConvertGeometries(m_pPending[nPending].m_pMetafile.get());
+  }
+};
+
+void OdGLES2JsonRendition::flushPendingMetafiles()
+{
+  if (m_pendingMetafiles.isEmpty())
+    return;
+  OdArray<PendingMetafile> pending = m_pendingMetafiles;
+  m_pendingMetafiles.clear();
+
+  OdRxThreadPoolServicePtr pThreadPool;
+  if (pending.size() > 1)
+    pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+  if (!pThreadPool.isNull())
+  {
+    ConvertWorker worker;
+    worker.m_pPending = pending.asArrayPtr();
+    odrxThreadPoolLoop(pThreadPool.get(), (OdUInt32)odmax(pThreadPool->numCPUs(), 1), pending.size(), worker);
+  }
+
+  // Ids and materials are assigned here, in order of metafiles adding, so output doesn't depend on threads
+  for (OdUInt32 n = 0; n < pending.size(); n++)
+    pending[n].m_pConverter->AddObjectsByRootId(json_obj(), pending[n].m_pMetafile.get(), pending[n].m_regId, pending[n].m_layerId);
 }
 
 void OdGLES2JsonRendition::OutputState(OdGLES2JsonServer::OutputState newState, bool bForce)
@@ -0,0 +1,148 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2017, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2017 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+//
+// GlesJsonServerBinImpl.cpp
+//
+
+#include "OdaCommon.h"
+#include "GlesJsonServerBinImpl.h"
+
+OdGlesJsonServerBinImpl::OdGlesJsonServerBinImpl(const OdDbBaseDatabase *pDb) // = NULL
+  : OdGlesJsonServerImpl(pDb)
+{
+}
+
+void OdGlesJsonServerBinImpl::setBinaryOutput(OdStreamBuf* buf, const OdString& sBufferName)
+{
+  m_pBinStream = buf;
+  // name is written between quotes into every buffer reference, so escape it once here
+  OdAnsiString sName(sBufferName, CP_UTF_8);
+  m_sBinName.empty();
+  for (const char *pCh = sName.c_str(); *pCh; ++pCh)
+  {
+    if (*pCh == '"' || *pCh == '\\')
+    {
+      m_sBinName += '\\';
+      m_sBinName += *pCh;
+    }
+    else if ((OdUInt8)*pCh < 0x20)
+    {
+      char buf[8];
+      sprintf(buf, "\\u%04x", (unsigned)(OdUInt8)*pCh);
+      m_sBinName += buf;
+    }
+    else
+      m_sBinName += *pCh;
+  }
+}
+
+bool OdGlesJsonServerBinImpl::setOutPathName(const OdString& sPathNameFormat,
+                                            OdUInt64 limitToSplit, // = OdUInt64() // if > OdUInt64() then willbe splited by next OnStateChanged
+                                            int indexNextFree) // = 0
+{
+  OdString sPathName = sPathNameFormat;
+  if (sPathNameFormat.find(L'%') >= 0)
+    sPathName.format(sPathNameFormat.c_str(), indexNextFree);
+  if (!OdGlesJsonServerImpl::setOutPathName(sPathNameFormat, limitToSplit, indexNextFree))
+    return false;
+
+  OdString sBinPath = sPathName + L".bin";
+  OdStreamBufPtr pBinStream = ::odrxSystemServices()->createFile(sBinPath.c_str(), Oda::kFileWrite,
+                                                                 Oda::kShareDenyWrite, Oda::kCreateAlways);
+  if (pBinStream.isNull())
+    return false;
+  // buffer is referenced relative to the JSON file
+  int nSep = odmax(sBinPath.reverseFind(L'/'), sBinPath.reverseFind(L'\\'));
+  setBinaryOutput(pBinStream, sBinPath.mid(nSep + 1));
+  return true;
+}
+
+int OdGlesJsonServerBinImpl::flushOut() // return next free index
+{
+  m_pBinStream = NULL;
+  return OdGlesJsonServerImpl::flushOut();
+}
+
+void OdGlesJsonServerBinImpl::DropInts(const char* pTagName, OdUInt32 nData, const OdUInt16* pData)
+{
+  if (m_pBinStream.isNull())
+    OdGlesJsonServerImpl::DropInts(pTagName, nData, pData);
+  else
+    dropBuffer(pTagName, pData, nData, sizeof(OdUInt16), "UInt16");
+}
+
+void OdGlesJsonServerBinImpl::DropUInts(const char* pTagName, OdUInt32 nData, const OdUInt32* pData)
+{
+  if (m_pBinStream.isNull())
+    OdGlesJsonServerImpl::DropUInts(pTagName, nData, pData);
+  else
+    dropBuffer(pTagName, pData, nData, sizeof(OdUInt32), "UInt32");
+}
+
+void OdGlesJsonServerBinImpl::DropFloats(const char* pTagName, OdUInt32 nData, const float* pData)
+{
+  // Float32 keeps full precision, so there is no need in "ArrayOffset" shift of the text mode
+  if (m_pBinStream.isNull())
+    OdGlesJsonServerImpl::DropFloats(pTagName, nData, pData);
+  else
+    dropBuffer(pTagName, pData, nData, sizeof(float), "Float32");
+}
+
+void OdGlesJsonServerBinImpl::dropBuffer(const char* pTagName, const void* pData, OdUInt32 nData, OdUInt32 nElemSize, const char* pComponentType)
+{
+  ODA_ASSERT_ONCE(nData && pData);
+  // each array starts 4-byte aligned, so client can map typed array views without copying
+  OdUInt64 nOffset = m_pBinStream->tell();
+  if (nOffset % 4)
+  {
+    static const OdUInt8 padding[4] = { 0, 0, 0, 0 };
+    m_pBinStream->putBytes(padding, OdUInt32(4 - nOffset % 4));
+    nOffset = m_pBinStream->tell();
+  }
+
+  const OdUInt32 nBytes = nData * nElemSize;
+#ifdef ODA_BIGENDIAN
+  OdUInt8 chunk[4096];
+  const OdUInt8* pSrc = (const OdUInt8*)pData;
+  for (OdUInt32 nDone = 0; nDone < nBytes; )
+  {
+    OdUInt32 nChunk = odmin(nBytes - nDone, (OdUInt32)sizeof(chunk));
+    ::memcpy(chunk, pSrc + nDone, nChunk);
+    for (OdUInt32 n = 0; n < nChunk; n += nElemSize)
+    {
+      if (nElemSize == 4)
+        odSwap4Bytes(chunk + n);
+      else
+        odSwapBytes(chunk[n], chunk[n + 1]);
+    }
+    m_pBinStream->putBytes(chunk, nChunk);
+    nDone += nChunk;
+  }
+#else
+  m_pBinStream->putBytes(pData, nBytes);
+#endif
+
+  m_sTmpBuf.format("\"buffer\":\"%s\",\"byteOffset\":" PRIu64 ",\"byteLength\":%u,\"componentType\":\"%s\"",
+                   m_sBinName.c_str(), nOffset, (unsigned)nBytes, pComponentType);
+  ident(pTagName, m_sTmpBuf.c_str(), OdGLES2JsonServer::kType);
+}
@@ -25,6 +25,7 @@
 #include "JsonMetafileConverter.h"
 #include "Tr/TrVisMetafileStream.h"
 #include "JsonObjectFormat.h"
+#include <new>
 
 #define COORDS_COUNT_AT_POINT 3
 #define COORDS_COUNT_AT_RGBA_COLOR 4
@@ -82,6 +83,7 @@ public:
     , m_material()
     , m_type(point_obj_type)
     , m_geometry_marker(JsonMetafileConverter::gm_default)
+    , m_buffers()
   {}
 
   JsonInterjacentObject(const ODCOLORREF &color, const kJsonObjType &object_type, const OdUInt64 &material_id, const JsonMetafileConverter::kGeomMarkerType &geometry_marker, const JsonMetafileConverter::kGeometryType &geometry_type)
@@ -89,16 +91,22 @@ public:
     , m_material(color, material_id)
     , m_type(object_type)
     , m_geometry_marker(geometry_marker)
+    , m_buffers()
   {}
 
+  // Geometry buffers are not copied, objects are copied into converter arena before conversion only
   JsonInterjacentObject(const JsonInterjacentObject &o)
     : m_geometry(o.m_geometry)
     , m_material(o.m_material)
     , m_type(o.m_type)
     , m_geometry_marker(o.m_geometry_marker)
+    , m_buffers()
   {}
 
-  virtual ~JsonInterjacentObject() {}
+  virtual ~JsonInterjacentObject()
+  {
+    FreeBuffers();
+  }
 
   void addRef() { }
   void release() { }
@@ -117,12 +125,86 @@ public:
   void SetGeometryID(const OdUInt64 &id) { m_geometry.first = id; }
 
   void CalculateMaterialLineWeight(JsonObjectFormat *json_obj);
+  // Adds to key the line weight which CalculateMaterialLineWeight applies to material
+  void FillMaterialKeyLineWeight(JsonMaterialKey &key) const;
+
+  // Fills geometry buffers from metafile arrays, doesn't access JsonObjectFormat
+  virtual void ConvertGeometries(const OdTrVisFlatMetafileContainer * /*pMetafile*/) {}
+
+  // Passes ownership of converted geometry buffers to geometry with current geometry id
+  void MoveBuffers(JsonObjectFormat *json_obj)
+  {
+    for (OdUInt32 n = 0; n < m_buffers.size(); n++)
+    {
+      GeometryBuffer &buf = m_buffers[n];
+      OdBool bAdded = buf.m_bIndices
+        ? json_obj->AddGeometriesData<OdUInt32>(m_geometry.first, buf.m_size, buf.m_pData, buf.m_data_type, JsonGeometriesDataBase::move_buffer)
+        : json_obj->AddGeometriesData<float>(m_geometry.first, buf.m_size, buf.m_pData, buf.m_data_type, JsonGeometriesDataBase::move_buffer);
+      if (bAdded)
+        buf.m_pData = NULL;
+    }
+    FreeBuffers();
+  }
 
 protected:
+  struct GeometryBuffer
+  {
+    JsonGeometriesDataBase::kDataType m_data_type;
+    OdUInt32 m_size;
+    void *m_pData;
+    bool m_bIndices;
+  };
+
+  void AddBuffer(OdUInt32 size, float *pData, const JsonGeometriesDataBase::kDataType &data_type)
+  {
+    AddBuffer(size, pData, data_type, false);
+  }
+  void AddBuffer(OdUInt32 size, OdUInt32 *pData, const JsonGeometriesDataBase::kDataType &data_type)
+  {
+    AddBuffer(size, pData, data_type, true);
+  }
+  void AddBufferCopy(OdUInt32 size, const float *pData, const JsonGeometriesDataBase::kDataType &data_type)
+  {
+    float *pCopy = new float[size / sizeof(float)];
+    memcpy(pCopy, pData, size);
+    AddBuffer(size, pCopy, data_type, false);
+  }
+
+  void FreeBuffers()
+  {
+    for (OdUInt32 n = 0; n < m_buffers.size(); n++)
+    {
+      if (m_buffers[n].m_bIndices)
+        delete[] (OdUInt32*)m_buffers[n].m_pData;
+      else
+        delete[] (float*)m_buffers[n].m_pData;
+    }
+    m_buffers.clear();
+  }
+
   std::pair<OdUInt64, JsonMetafileConverter::kGeometryType> m_geometry;
   JsonInterjacentMat m_material;
   kJsonObjType m_type;
   JsonMetafileConverter::kGeomMarkerType m_geometry_marker;
+  OdArray<GeometryBuffer, OdMemoryAllocator<GeometryBuffer> > m_buffers;
+
+private:
+  void AddBuffer(OdUInt32 size, void *pData, const JsonGeometriesDataBase::kDataType &data_type, bool bIndices)
+  {
+    GeometryBuffer buf = { data_type, size, pData, bIndices };
+    try
+    {
+      m_buffers.push_back(buf);
+    }
+    catch (...)
+    {
+      if (bIndices)
+        delete[] (OdUInt32*)pData;
+      else
+        delete[] (float*)pData;
+      throw;
+    }
+  }
 };
 
 class JsonInterjacentMetafileObject : public JsonInterjacentObject
@@ -143,6 +225,8 @@ public:
 
   virtual ~JsonInterjacentMetafileObject() {}
 
+  const JsonMetafileConverter::line_weight &GetLineWeight() const { return m_weight; }
+
   void RecalcMaterialLineWeight(const OdUInt64 &material_id, JsonObjectFormat *json_obj)
   {
     if (m_weight.GetType() == JsonMetafileConverter::line_weight::i16_val ||
@@ -211,13 +295,18 @@ public:
       delete[] m_vertex;
   }
 
-  void AddVertex(JsonObjectFormat *json_obj)
+  virtual void ConvertGeometries(const OdTrVisFlatMetafileContainer * /*pMetafile*/)
   {
+    if (m_vertex == NULL)
+      return;
+    float *vertex = m_vertex;
+    m_vertex = NULL;
     if (m_type == JsonInterjacentObject::vline_obj_type)
-      json_obj->AddGeometriesData<float>(m_geometry.first, sizeof(float) * VObject::line_vertex_count, (void*)m_vertex, JsonGeometriesDataBase::vertec, JsonGeometriesDataBase::move_buffer);
+      AddBuffer(sizeof(float) * VObject::line_vertex_count, vertex, JsonGeometriesDataBase::vertec);
     else if (m_type == JsonInterjacentObject::vpoint_obj_type)
-      json_obj->AddGeometriesData<float>(m_geometry.first, sizeof(float) * VObject::point_vertex_count, (void*)m_vertex, JsonGeometriesDataBase::vertec, JsonGeometriesDataBase::move_buffer);
-    m_vertex = NULL;
+      AddBuffer(sizeof(float) * VObject::point_vertex_count, vertex, JsonGeometriesDataBase::vertec);
+    else
+      delete[] vertex;
   }
 
 protected:
@@ -252,7 +341,7 @@ public:
 
   virtual ~DataArrayObject() {}
 
-  void AddVertex(JsonObjectFormat *obj, const float *pData, const OdTrVisArrayWrapper &index_array)
+  void AddVertex(const float *pData, const OdTrVisArrayWrapper &index_array)
   {
     float *vertex = NULL;
 
@@ -271,18 +360,19 @@ public:
         }
       }
 
-      obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)(vertex), JsonGeometriesDataBase::vertec, JsonGeometriesDataBase::move_buffer);
+      float *pBuf = vertex;
       vertex = NULL;
+      AddBuffer(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pBuf, JsonGeometriesDataBase::vertec);
     }
     catch (...)
     {
-      if (vertex == NULL)
+      if (vertex != NULL)
         delete[]vertex;
       throw;
     }
   }
 
-  void AddNormal(JsonObjectFormat *obj, const float *pData, const OdTrVisArrayWrapper &index_array)
+  void AddNormal(const float *pData, const OdTrVisArrayWrapper &index_array)
   {
     float *normal = NULL;
 
@@ -301,18 +391,19 @@ public:
         }
       }
 
-      obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)(normal), JsonGeometriesDataBase::normal, JsonGeometriesDataBase::move_buffer);
+      float *pBuf = normal;
       normal = NULL;
+      AddBuffer(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pBuf, JsonGeometriesDataBase::normal);
     }
     catch (...)
     {
-      if (normal == NULL)
+      if (normal != NULL)
         delete[]normal;
       throw;
     }
   }
 
-  void ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTrVisFlatMetafileContainer *pMetafile);
+  virtual void ConvertGeometries(const OdTrVisFlatMetafileContainer *pMetafile);
 
   const OdInt32 &GetFirstCoordIndex() const { return m_first_index; }
   const OdInt32 &GetCoordsCount() const { return m_count; }
@@ -340,9 +431,15 @@ public:
 
   virtual ~FaceObject() {}
 
-  void AddFaces(JsonObjectFormat *obj)
+  virtual void ConvertGeometries(const OdTrVisFlatMetafileContainer *pMetafile)
+  {
+    DataArrayObject::ConvertGeometries(pMetafile);
+    AddFaces();
+  }
+
+  void AddFaces()
   {
-    OdInt32 *faces = NULL;
+    OdUInt32 *faces = NULL;
     try
     {
       OdUInt32 step = COORDS_COUNT_AT_POINT;
@@ -351,7 +448,7 @@ public:
       if (m_face_form & JsonMetafileConverter::vertex_color)
         step += COORDS_COUNT_AT_POINT;
       OdUInt32 size = (m_count * (step + 1)) / COORDS_COUNT_AT_POINT;
-      faces = new OdInt32[size];
+      faces = new OdUInt32[size];
 
       OdInt32 vert_coord = 0;
       OdInt32 norm_coord = 0;
@@ -378,8 +475,9 @@ public:
         }
       }
 
-      obj->AddGeometriesData<OdUInt32>(m_geometry.first, size * sizeof(OdUInt32), (void*)faces, JsonGeometriesDataBase::face, JsonGeometriesDataBase::move_buffer);
+      OdUInt32 *pBuf = faces;
       faces = NULL;
+      AddBuffer(size * sizeof(OdUInt32), pBuf, JsonGeometriesDataBase::face);
     }
     catch (...)
     {
@@ -389,7 +487,7 @@ public:
     }
   }
 
-  void AddColors(JsonObjectFormat *obj, const float *pData)
+  void AddColors(const float *pData)
   {
     float *color = NULL;
 
@@ -403,8 +501,9 @@ public:
         ++step;
       }
 
-      obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)color, JsonGeometriesDataBase::color, JsonGeometriesDataBase::move_buffer);
+      float *pBuf = color;
       color = NULL;
+      AddBuffer(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pBuf, JsonGeometriesDataBase::color);
     }
     catch (...)
     {
@@ -414,7 +513,7 @@ public:
     }
   }
 
-  void AddColors(JsonObjectFormat *obj, const float *pData, const OdTrVisArrayWrapper &index_array)
+  void AddColors(const float *pData, const OdTrVisArrayWrapper &index_array)
   {
     float *color = NULL;
 
@@ -434,8 +533,9 @@ public:
         }
       }
 
-      obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)color, JsonGeometriesDataBase::color, JsonGeometriesDataBase::move_buffer);
+      float *pBuf = color;
       color = NULL;
+      AddBuffer(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pBuf, JsonGeometriesDataBase::color);
     }
     catch (...)
     {
@@ -470,7 +570,26 @@ void JsonInterjacentObject::CalculateMaterialLineWeight(JsonObjectFormat *json_o
   }
 }
 
-void DataArrayObject::ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTrVisFlatMetafileContainer *pMetafile)
+void JsonInterjacentObject::FillMaterialKeyLineWeight(JsonMaterialKey &key) const
+{
+  if (m_type == JsonInterjacentObject::line_obj_type ||
+    m_type == JsonInterjacentObject::point_obj_type ||
+    m_type == JsonInterjacentObject::vline_obj_type ||
+    m_type == JsonInterjacentObject::vpoint_obj_type)
+  {
+    const JsonInterjacentMetafileObject * p_obj = dynamic_cast<const JsonInterjacentMetafileObject*> (this);
+    if (p_obj != NULL)
+    {
+      const JsonMetafileConverter::line_weight &weight = p_obj->GetLineWeight();
+      if (weight.GetType() == JsonMetafileConverter::line_weight::float_val)
+        key.SetLineWeight((OdUInt8)weight.GetType(), 0, weight.GetDoubleVal());
+      else
+        key.SetLineWeight((OdUInt8)weight.GetType(), weight.GetIntVal(), 0);
+    }
+  }
+}
+
+void DataArrayObject::ConvertGeometries(const OdTrVisFlatMetafileContainer *pMetafile)
 {
   const JsonMetafileConverter::kGeomArrayType * arr_el = m_array.begin();
   while (arr_el != m_array.end())
@@ -482,12 +601,12 @@ void DataArrayObject::ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTr
       {
         const float *pData = (const float*)array.m_pData;
         if (m_geometry.second == JsonMetafileConverter::geometry)
-          json_obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)(pData + m_first_index * COORDS_COUNT_AT_POINT), JsonGeometriesDataBase::vertec);
+          AddBufferCopy(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pData + m_first_index * COORDS_COUNT_AT_POINT, JsonGeometriesDataBase::vertec);
         else if (m_geometry.second == JsonMetafileConverter::buffer_geometry)
         {
           const OdTrVisArrayWrapper &index_array = pMetafile->m_ArrayElements.getPtr()[m_ind_of_index_array];
           if (index_array.m_type == OdTrVisArrayWrapper::Type_Index && m_count > 0)
-            AddVertex(json_obj, pData, index_array);
+            AddVertex(pData, index_array);
         }
         break;
       }
@@ -501,12 +620,12 @@ void DataArrayObject::ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTr
           if (p_obj_face->GetFaceForm() & JsonMetafileConverter::vertex_normal)
           {
             if (m_geometry.second == JsonMetafileConverter::geometry)
-              json_obj->AddGeometriesData<float>(m_geometry.first, m_count * sizeof(float) * COORDS_COUNT_AT_POINT, (void*)(pData + m_first_index * COORDS_COUNT_AT_POINT), JsonGeometriesDataBase::normal);
+              AddBufferCopy(m_count * sizeof(float) * COORDS_COUNT_AT_POINT, pData + m_first_index * COORDS_COUNT_AT_POINT, JsonGeometriesDataBase::normal);
             else if (m_geometry.second == JsonMetafileConverter::buffer_geometry)
             {
               const OdTrVisArrayWrapper &index_array = pMetafile->m_ArrayElements.getPtr()[m_ind_of_index_array];
               if (index_array.m_type == OdTrVisArrayWrapper::Type_Index && m_count > 0)
-                AddNormal(json_obj, pData, index_array);
+                AddNormal(pData, index_array);
             }
           }
         }
@@ -521,12 +640,12 @@ void DataArrayObject::ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTr
           if (p_obj_face->GetFaceForm() & JsonMetafileConverter::vertex_color)
           {
             if (m_geometry.second == JsonMetafileConverter::geometry)
-              p_obj_face->AddColors(json_obj, pData);
+              p_obj_face->AddColors(pData);
             else if (m_geometry.second == JsonMetafileConverter::buffer_geometry)
             {
               const OdTrVisArrayWrapper &index_array = pMetafile->m_ArrayElements.getPtr()[m_ind_of_index_array];
               if (index_array.m_type == OdTrVisArrayWrapper::Type_Index && m_count > 0)
-                p_obj_face->AddColors(json_obj, pData, index_array);
+                p_obj_face->AddColors(pData, index_array);
             }
           }
         }
@@ -543,9 +662,61 @@ void DataArrayObject::ParseGeometryArrays(JsonObjectFormat *json_obj, const OdTr
   }
 }
 
+////////////////////
+//JsonMetafileConverter::Arena
+
+void *JsonMetafileConverter::Arena::allocate(size_t nBytes)
+{
+  nBytes = (nBytes + sizeof(double) - 1) & ~(sizeof(double) - 1);
+  const bool bOwnChunk = nBytes > (size_t)kChunkSize;
+  if (!bOwnChunk && m_nUsed + nBytes <= (size_t)kChunkSize)
+  {
+    void *pRes = m_chunks.back() + m_nUsed;
+    m_nUsed += nBytes;
+    return pRes;
+  }
+  m_chunks.reserve(m_chunks.size() + 1);
+  OdUInt8 *pChunk = (OdUInt8*)::odrxAlloc(bOwnChunk ? nBytes : (size_t)kChunkSize);
+  if (!pChunk)
+    throw OdError(eOutOfMemory);
+  if (bOwnChunk)
+  { // Oversized object gets own chunk, current chunk stays open
+    m_chunks.insert(m_chunks.begin(), pChunk);
+    return pChunk;
+  }
+  m_chunks.push_back(pChunk);
+  m_nUsed = nBytes;
+  return pChunk;
+}
+
+void JsonMetafileConverter::Arena::clear()
+{
+  for (size_t n = 0; n < m_chunks.size(); n++)
+    ::odrxFree(m_chunks[n]);
+  m_chunks.clear();
+  m_nUsed = kChunkSize;
+}
+
 ////////////////////
 //JsonMetafileConverter
 
+JsonMetafileConverter::~JsonMetafileConverter()
+{
+  for (size_t n = 0; n < m_objs.size(); n++)
+    m_objs[n]->~JsonInterjacentObject();
+  m_objs.clear();
+  m_arena.clear();
+}
+
+template <class TObject>
+TObject *JsonMetafileConverter::NewObject(const TObject &obj)
+{
+  m_objs.reserve(m_objs.size() + 1);
+  TObject *pObj = ::new (m_arena.allocate(sizeof(TObject))) TObject(obj);
+  m_objs.push_back(pObj);
+  return pObj;
+}
+
 void JsonMetafileConverter::DeleteGeometryArrayByType(OdUInt8 type)
 {
   std::map<OdUInt32, OdUInt8>::iterator beg = m_geometry_arrays.begin();
@@ -565,67 +736,76 @@ void JsonMetafileConverter::DeleteGeometryArrayByType(OdUInt8 type)
 
 void JsonMetafileConverter::AddPoint(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type, const OdUInt32 &ind)
 {
-  m_objs.push_back(OdRxObjectPtr(new DataArrayObject(m_rgb, JsonInterjacentObject::point_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight)));
+  NewObject(DataArrayObject(m_rgb, JsonInterjacentObject::point_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight));
 }
 void JsonMetafileConverter::AddPoint(const float *pFloats)
 {
-  m_objs.push_back(OdRxObjectPtr(new VObject(m_rgb, JsonInterjacentObject::vpoint_obj_type, m_material_id, pFloats, JsonMetafileConverter::geometry, m_weight)));
+  NewObject(VObject(m_rgb, JsonInterjacentObject::vpoint_obj_type, m_material_id, pFloats, JsonMetafileConverter::geometry, m_weight));
 }
 void JsonMetafileConverter::AddLine(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type, const OdUInt32 &ind)
 {
-  m_objs.push_back(OdRxObjectPtr(new DataArrayObject(m_rgb, JsonInterjacentObject::line_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight)));
+  NewObject(DataArrayObject(m_rgb, JsonInterjacentObject::line_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight));
 }
 void JsonMetafileConverter::AddLine(const float *pFloats)
 {
-  m_objs.push_back(OdRxObjectPtr(new VObject(m_rgb, JsonInterjacentObject::vline_obj_type, m_material_id, pFloats, JsonMetafileConverter::geometry, m_weight)));
+  NewObject(VObject(m_rgb, JsonInterjacentObject::vline_obj_type, m_material_id, pFloats, JsonMetafileConverter::geometry, m_weight));
 }
 void JsonMetafileConverter::AddLineStrip(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type, const OdUInt32 &ind)
 {
-  m_objs.push_back(OdRxObjectPtr(new DataArrayObject(m_rgb, JsonInterjacentObject::line_strip_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight)));
+  NewObject(DataArrayObject(m_rgb, JsonInterjacentObject::line_strip_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, geom_type, ind, m_weight));
 }
 void JsonMetafileConverter::AddMesh(const OdInt32 &first, const OdInt32 &count, const kGeometryType &geom_type, const OdUInt32 &ind)
 {
-  m_objs.push_back(OdRxObjectPtr(new FaceObject(m_rgb, JsonInterjacentObject::mesh_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, m_faces_form, geom_type, ind)));
+  NewObject(FaceObject(m_rgb, JsonInterjacentObject::mesh_obj_type, &m_geometry_arrays, first, count, m_material_id, m_geom_marker_type, m_faces_form, geom_type, ind));
+}
+
+void JsonMetafileConverter::ConvertGeometries(const OdTrVisFlatMetafileContainer *pMetafile)
+{
+  if (m_bGeometriesConverted)
+    return;
+  for (size_t n = 0; n < m_objs.size(); n++)
+    m_objs[n]->ConvertGeometries(pMetafile);
+  m_bGeometriesConverted = true;
 }
 
 void JsonMetafileConverter::AddObjectsByRootId(JsonObjectFormat *json_obj, const OdTrVisFlatMetafileContainer *pMetafile, const OdUInt64 &root_id, const OdUInt64 &layer_id)
 {
+  ConvertGeometries(pMetafile);
   json_obj->AddObjectByLayer(layer_id, root_id);
 
-  std::map<JsonInterjacentObject::kJsonObjType, JsonInterjacentObject::JsonInterjacentMat*> cur_type_materials;
-
-  std::vector<OdRxObjectPtr>::iterator ptr = m_objs.begin();
+  std::vector<JsonInterjacentObject*>::iterator ptr = m_objs.begin();
   while (ptr != m_objs.end())
   {
-    JsonInterjacentObject*const p_json_obj = dynamic_cast<JsonInterjacentObject*> (ptr->get());
+    JsonInterjacentObject*const p_json_obj = *ptr;
     if (p_json_obj != NULL)
     {
-      //object material
-      std::map<JsonInterjacentObject::kJsonObjType, JsonInterjacentObject::JsonInterjacentMat*>::iterator old_mat = cur_type_materials.find(p_json_obj->GetType());
-      if (old_mat != cur_type_materials.end() &&
-        old_mat->second != NULL &&
-        old_mat->second->GetCopyByMaterialID() == p_json_obj->GetCopyByMaterialID() &&
-        old_mat->second->GetRGB() == p_json_obj->GetMaterialRGB())
-        p_json_obj->SetMaterialID(old_mat->second->GetMaterialID());
-      else
+      //object material, every distinct material is written once for whole scene
+      JsonMaterials::kMaterialType mat_type = JsonMaterials::default_mat_type;
+      switch (p_json_obj->GetType())
       {
-        JsonMaterials::kMaterialType mat_type = JsonMaterials::default_mat_type;
-        switch (p_json_obj->GetType())
-        {
-          case JsonInterjacentObject::vpoint_obj_type:
-          case JsonInterjacentObject::point_obj_type:
-            mat_type = JsonMaterials::point_mat_type;
-          break;
-          case JsonInterjacentObject::line_obj_type:
-          case JsonInterjacentObject::vline_obj_type:
-          case JsonInterjacentObject::line_strip_obj_type:
-            mat_type = JsonMaterials::line_basic_mat_type;
-          break;
-          case JsonInterjacentObject::mesh_obj_type:
-            mat_type = JsonMaterials::mesh_basic_mat_type;
-          break;
-        }
+        case JsonInterjacentObject::vpoint_obj_type:
+        case JsonInterjacentObject::point_obj_type:
+          mat_type = JsonMaterials::point_mat_type;
+        break;
+        case JsonInterjacentObject::line_obj_type:
+        case JsonInterjacentObject::vline_obj_type:
+        case JsonInterjacentObject::line_strip_obj_type:
+          mat_type = JsonMaterials::line_basic_mat_type;
+        break;
+        case JsonInterjacentObject::mesh_obj_type:
+          mat_type = JsonMaterials::mesh_basic_mat_type;
+        break;
+      }
+
+      JsonMaterialKey mat_key(mat_type, p_json_obj->GetCopyByMaterialID(), p_json_obj->GetMaterialRGB());
+      if (p_json_obj->GetCopyByMaterialID() == 0)
+        p_json_obj->FillMaterialKeyLineWeight(mat_key);
 
+      const OdUInt64 mat_id = json_obj->FindMaterialByKey(mat_key);
+      if (mat_id != 0)
+        p_json_obj->SetMaterialID(mat_id);
+      else
+      {
         if (p_json_obj->GetCopyByMaterialID() != 0)
           p_json_obj->SetMaterialID(json_obj->CopyMaterial(p_json_obj->GetCopyByMaterialID(), mat_type));
         else
@@ -636,46 +816,16 @@ void JsonMetafileConverter::AddObjectsByRootId(JsonObjectFormat *json_obj, const
           p_json_obj->CalculateMaterialLineWeight(json_obj);
         }
 
-        if (old_mat == cur_type_materials.end())
-          cur_type_materials.insert(std::pair<JsonInterjacentObject::kJsonObjType, JsonInterjacentObject::JsonInterjacentMat*>(p_json_obj->GetType(), p_json_obj->GetMaterial()));
-        else
-          old_mat->second = p_json_obj->GetMaterial();
-
-        json_obj->AddMaterialColor(p_json_obj->GetMaterialID(), JsonMaterialColor::main_color, m_rgb);
+        json_obj->AddMaterialColor(p_json_obj->GetMaterialID(), JsonMaterialColor::main_color, p_json_obj->GetMaterialRGB());
+        if (p_json_obj->GetMaterialID() != 0)
+          json_obj->AddMaterialKey(mat_key, p_json_obj->GetMaterialID());
       }
 
       //object geometries
       p_json_obj->SetGeometryID(json_obj->GetNewGeometryUUID());
       json_obj->AddGeometries(p_json_obj->GetGeometryID(), JsonGeometries::Geometry);
-
-      if (p_json_obj->GetType() == JsonInterjacentObject::vline_obj_type)
-      {
-        VObject * p_obj = dynamic_cast<VObject*> (p_json_obj);
-        if (p_obj != NULL)
-          p_obj->AddVertex(json_obj);
-      }
-      else if (p_json_obj->GetType() == JsonInterjacentObject::vpoint_obj_type)
-      {
-        VObject * p_obj = dynamic_cast<VObject*> (p_json_obj);
-        if (p_obj != NULL)
-          p_obj->AddVertex(json_obj);
-      }
-      else
-      {
-        //geometries arrays
-        DataArrayObject * p_obj = dynamic_cast<DataArrayObject*> (p_json_obj);
-        if (p_obj != NULL)
-        {
-          p_obj->ParseGeometryArrays(json_obj, pMetafile);
-
-          if (p_obj->GetType() == JsonInterjacentObject::mesh_obj_type)
-          {
-            FaceObject * p_f_obj = dynamic_cast<FaceObject*> (p_obj);
-            if (p_f_obj != NULL)
-              p_f_obj->AddFaces(json_obj);
-          }
-        }
-      }
+      //geometries arrays, converted before
+      p_json_obj->MoveBuffers(json_obj);
 
       //objects child
       OdBool obj_visible = true;
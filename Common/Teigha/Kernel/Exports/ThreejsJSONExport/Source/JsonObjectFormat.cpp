@@ -30,7 +30,7 @@ class OdGLES2JsonNestingLevel
 {
   OdGLES2JsonServer *m_pJson;
   const char *m_pText;
-  const OdGLES2JsonServer::JsonType &m_pDel;
+  const OdGLES2JsonServer::JsonType m_pDel;
 public:
   OdGLES2JsonNestingLevel(OdGLES2JsonServer *pJson, const char *pText, const OdGLES2JsonServer::JsonType &pDel)
     : m_pJson(pJson)
@@ -414,6 +414,20 @@ OdUInt64 JsonObjectFormat::CopyMaterial(const OdUInt64& id, const JsonMaterials:
   return res;
 }
 
+OdUInt64 JsonObjectFormat::FindMaterialByKey(const JsonMaterialKey &key) const
+{
+  std::map<JsonMaterialKey, OdUInt64>::const_iterator it = m_material_keys.find(key);
+  if (it != m_material_keys.end())
+    return it->second;
+  else
+    return 0;
+}
+
+void JsonObjectFormat::AddMaterialKey(const JsonMaterialKey &key, const OdUInt64 &id)
+{
+  m_material_keys[key] = id;
+}
+
 void JsonObjectFormat::AddMaterialLenWeightIndx(const OdUInt64 &mat_id, const OdInt16 &lens_ind)
 {
   if (m_camera_options != NULL)
@@ -740,7 +754,7 @@ struct geomerty_for_each_pred
     , nLevel(l)
   {}
 
-  void operator()(const JsonGeometriesDataPtr &geom_attr)
+  void operator()(const JsonGeometriesDataBase &geom_attr)
   {
     if (is_first)
       is_first = false;
@@ -748,7 +762,7 @@ struct geomerty_for_each_pred
       JSON_DROP_COMMA()
 
     const char *type = "";
-    switch (geom_attr->GetDataType())
+    switch (geom_attr.GetDataType())
     {
       case JsonGeometriesDataBase::normal:
         type = "normals";
@@ -768,32 +782,32 @@ struct geomerty_for_each_pred
     JSON_TYPE_LEVEL(level, type);
     ++(*nLevel);
 
-    if (dynamic_cast<const JsonGeometriesData<float>* >(geom_attr.get()) != NULL)
+    if (geom_attr.GetElementType() == JsonGeometriesDataBase::float_element)
     {
-      const OdUInt32 &nData = (geom_attr.get())->GetSize() / sizeof(float);
+      const OdUInt32 &nData = geom_attr.GetSize() / sizeof(float);
       pJson->DropUInt32("size", nData / 3);
       JSON_DROP_COMMA()
       pJson->DropString("type", "Float32Array");
       JSON_DROP_COMMA()
-      pJson->DropFloats("array", nData, dynamic_cast<const JsonGeometriesData<float>* >(geom_attr.get())->GetArray());
+      pJson->DropFloats("array", nData, geom_attr.GetArray<float>());
     }
-    else if (dynamic_cast<const JsonGeometriesData<OdUInt32>* >(geom_attr.get()) != NULL)
+    else if (geom_attr.GetElementType() == JsonGeometriesDataBase::uint32_element)
     {
-      const OdUInt32 &nData = (geom_attr.get())->GetSize() / sizeof(OdUInt32);
+      const OdUInt32 &nData = geom_attr.GetSize() / sizeof(OdUInt32);
       pJson->DropUInt32("size", nData);
       JSON_DROP_COMMA()
       pJson->DropString("type", "UInt32Array");
       JSON_DROP_COMMA()
-      pJson->DropUInts("array", nData, dynamic_cast<const JsonGeometriesData<OdUInt32>* >(geom_attr.get())->GetArray());
+      pJson->DropUInts("array", nData, geom_attr.GetArray<OdUInt32>());
     }
-    else if (dynamic_cast<const JsonGeometriesData<OdUInt16>* >(geom_attr.get()) != NULL)
+    else if (geom_attr.GetElementType() == JsonGeometriesDataBase::uint16_element)
     {
-      const OdUInt32 &nData = (geom_attr.get())->GetSize() / sizeof(OdUInt16);
+      const OdUInt32 &nData = geom_attr.GetSize() / sizeof(OdUInt16);
       pJson->DropUInt32("size", nData);
       JSON_DROP_COMMA()
       pJson->DropString("type", "UInt16Array");
       JSON_DROP_COMMA()
-      pJson->DropInts("array", nData, dynamic_cast<const JsonGeometriesData<OdUInt16>* >(geom_attr.get())->GetArray());
+      pJson->DropInts("array", nData, geom_attr.GetArray<OdUInt16>());
     }
 
     --(*nLevel);
@@ -814,7 +828,7 @@ struct geometry2_for_each_pred
     , withVertices(v)
   {}
 
-  void operator()(const JsonGeometriesDataPtr &geom_attr)
+  void operator()(const JsonGeometriesDataBase &geom_attr)
   {
     if (is_first)
       is_first = false;
@@ -822,7 +836,7 @@ struct geometry2_for_each_pred
       JSON_DROP_COMMA()
 
     const char *type = NULL;
-    switch (geom_attr->GetDataType())
+    switch (geom_attr.GetDataType())
     {
       case JsonGeometriesDataBase::normal:
         type = "normals";
@@ -840,15 +854,15 @@ struct geometry2_for_each_pred
         break;
     }
 
-    if (dynamic_cast<const JsonGeometriesData<float>* >(geom_attr.get()) != NULL)
+    if (geom_attr.GetElementType() == JsonGeometriesDataBase::float_element)
     {
-      const OdUInt32 &nData = (geom_attr.get())->GetSize() / sizeof(float);
-      pJson->DropFloats(type, nData, dynamic_cast<const JsonGeometriesData<float>* >(geom_attr.get())->GetArray());
+      const OdUInt32 &nData = geom_attr.GetSize() / sizeof(float);
+      pJson->DropFloats(type, nData, geom_attr.GetArray<float>());
     }
-    else if (dynamic_cast<const JsonGeometriesData<OdUInt32>* >(geom_attr.get()) != NULL)
+    else if (geom_attr.GetElementType() == JsonGeometriesDataBase::uint32_element)
     {
-      const OdUInt32 &nData = (geom_attr.get())->GetSize() / sizeof(OdUInt32);
-      pJson->DropUInts(type, nData, dynamic_cast<const JsonGeometriesData<OdUInt32>* >(geom_attr.get())->GetArray());
+      const OdUInt32 &nData = geom_attr.GetSize() / sizeof(OdUInt32);
+      pJson->DropUInts(type, nData, geom_attr.GetArray<OdUInt32>());
     }
   }
 
@@ -32,6 +32,7 @@
 #include "RxDispatchImpl.h"
 #include "GlesJsonServerBaseImpl.h"
 #include "GlesJsonServerImpl.h"
+#include "GlesJsonServerBinImpl.h"
 #include "ExGsGLES2JsonRendition.h"
 
 namespace TD_THREEJSJSON_EXPORT
@@ -106,7 +107,7 @@ namespace TD_THREEJSJSON_EXPORT
     virtual void vectorizationTest(OdGsDevice* pDevice) const;
   };
 
-  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod = TryToVectorizeMod());
+  void tryToVectorize(OdStreamBuf *pOutStream, OdStreamBuf *pBinStream, const OdString &sBinName, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod = TryToVectorizeMod());
 
 
   OdGsDevicePtr TryToVectorizeMod::initDevice(OdDbBaseDatabase *pDb, OdGsDevice* pDevice, const ODCOLORREF &background) const
@@ -129,7 +130,7 @@ namespace TD_THREEJSJSON_EXPORT
     pDevice->update();
   }
 
-  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod)
+  void tryToVectorize(OdStreamBuf *pOutStream, OdStreamBuf *pBinStream, const OdString &sBinName, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod)
   {
     odgsInitialize();
     OdGsModulePtr pGsModule = ODRX_STATIC_MODULE_ENTRY_POINT(TrJsonModule)(OD_T("TrJsonModule"));
@@ -141,7 +142,15 @@ namespace TD_THREEJSJSON_EXPORT
     OdGsDCRect screenRect(OdGsDCPoint(0, 2000), OdGsDCPoint(2000, 0));
     pDevice->onSize(screenRect);
 
-    OdSharedPtr<OdGlesJsonServerBaseImpl> pJsonServer = new OdGlesJsonServerImpl(pDb);
+    OdSharedPtr<OdGlesJsonServerBaseImpl> pJsonServer;
+    if (pBinStream)
+    {
+      OdGlesJsonServerBinImpl *pBinServer = new OdGlesJsonServerBinImpl(pDb);
+      pBinServer->setBinaryOutput(pBinStream, sBinName);
+      pJsonServer = pBinServer;
+    }
+    else
+      pJsonServer = new OdGlesJsonServerImpl(pDb);
     pJsonServer->setOutput(pOutStream);
     pJsonServer->setSkipShaders(true);
     pJsonServer->setEnableFaces(bFacesEnabled);
@@ -172,13 +181,13 @@ namespace TD_THREEJSJSON_EXPORT
     odgsUninitialize();
   }
 
-  OdResult doExport(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled)
+  OdResult doExport(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, OdStreamBuf *pBinStream, const OdString &sBinName, const ODCOLORREF &background, bool bFacesEnabled)
   {
     OdResult ret = eOk;
 
     try
     {
-      tryToVectorize(pOutStream, pDb, background, bFacesEnabled);
+      tryToVectorize(pOutStream, pBinStream, sBinName, pDb, background, bFacesEnabled);
     }
     catch (const OdError& e)
     {
@@ -194,6 +203,13 @@ namespace TD_THREEJSJSON_EXPORT
 
   OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled)
   {
-    return doExport(pDb, pOutStream, background, bFacesEnabled);
+    return doExport(pDb, pOutStream, NULL, OdString::kEmpty, background, bFacesEnabled);
+  }
+
+  OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, OdStreamBuf *pBufferStream, const OdString &sBufferName, const ODCOLORREF &background, bool bFacesEnabled)
+  {
+    if (!pBufferStream)
+      return eInvalidInput;
+    return doExport(pDb, pOutStream, pBufferStream, sBufferName, background, bFacesEnabled);
   }
 };
@@ -24,13 +24,65 @@
 #include "OdaCommon.h"
 #include "BmpTilesGen.h"
 #include "RxDictionary.h"
+#include "RxDynamicModule.h"
+#include "DynamicLinker.h"
+#include "RxThreadPoolLoop.h"
+#include "OdModuleNames.h"
+#include "DbBaseDatabase.h"
+#include "Gi/GiCommonDraw.h"
 #include <algorithm>
 
+static OdGiRasterImagePtr regenDeviceTile(OdGsDevice* pDevice, const OdGsDCRect& rcOverall, const OdGsDCRect& rcTile);
+
+namespace
+{
+  // Renders a tile with the device of the calling thread.
+  struct TileRenderer
+  {
+    OdGsDevice* const*   m_pDevices;
+    OdGsDCRect           m_rcOverall;
+    const OdGsDCRect*    m_pTiles;
+    OdGiRasterImagePtr*  m_pImages;
+
+    void operator()(OdUInt32 nTile, OdUInt32 nThread)
+    {
+      OdGiRasterImagePtr pImage = regenDeviceTile(m_pDevices[nThread], m_rcOverall, m_pTiles[nTile]);
+      // device image may be the device itself, keep a copy before the next tile
+      if (!pImage.isNull())
+        pImage = pImage->crop(0, 0, pImage->pixelWidth(), pImage->pixelHeight());
+      m_pImages[nTile] = pImage;
+    }
+  };
+
+  // Keeps database in multithreaded rendering mode, also if the queue throws, and restores
+  // the previous mode. OdDbBaseDatabasePE can't report the mode, so it is passed by the caller.
+  struct MtRenderGuard
+  {
+    OdDbBaseDatabase*      m_pDb;
+    OdDbBaseDatabasePEPtr  m_pDbPE;
+
+    MtRenderGuard(OdDbBaseDatabase* pDb, bool bWasOn) : m_pDb(pDb)
+    {
+      if (!bWasOn)
+        m_pDbPE = OdDbBaseDatabasePE::cast(pDb);
+      if (m_pDbPE.get())
+        m_pDbPE->setMultiThreadedRender(m_pDb, true);
+    }
+    ~MtRenderGuard()
+    {
+      if (m_pDbPE.get())
+        m_pDbPE->setMultiThreadedRender(m_pDb, false);
+    }
+  };
+}
+
 BmpTilesGen::BmpTilesGen()
+  : m_bMtRenderOn(false)
 {
 }
 
 BmpTilesGen::BmpTilesGen(OdGsDevice* pDevice, const OdGsDCRect& rcOverall)
+  : m_bMtRenderOn(false)
 {
   init(pDevice, rcOverall);
 }
@@ -42,6 +94,64 @@ void BmpTilesGen::init(OdGsDevice* pDevice, const OdGsDCRect& rcOverall)
 }
 
 OdGiRasterImagePtr BmpTilesGen::regenTile(const OdGsDCRect& rcTile)
+{
+  return regenDeviceTile(m_pDevice, m_rcOverall, rcTile);
+}
+
+void BmpTilesGen::addWorkerDevice(OdGsDevice* pDevice)
+{
+  m_workerDevices.append(pDevice);
+}
+
+void BmpTilesGen::clearWorkerDevices()
+{
+  m_workerDevices.clear();
+}
+
+void BmpTilesGen::setMultiThreadedRenderOn(bool bOn)
+{
+  m_bMtRenderOn = bOn;
+}
+
+void BmpTilesGen::regenTiles(const OdGsDCRect* pTiles, OdUInt32 nTiles, OdArray<OdGiRasterImagePtr>& images, OdUInt32 nMaxThreads)
+{
+  images.clear();
+  images.resize(nTiles);
+  if (!nTiles)
+    return;
+
+  OdUInt32 nThreads = m_workerDevices.size() + 1;
+  if (nMaxThreads && nMaxThreads < nThreads)
+    nThreads = nMaxThreads;
+  if (nThreads > nTiles)
+    nThreads = nTiles;
+
+  OdRxThreadPoolServicePtr pThreadPool;
+  if (nThreads > 1)
+    pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+
+  OdArray<OdGsDevice*> devices;
+  devices.reserve(nThreads);
+  devices.append(m_pDevice.get());
+  for (OdUInt32 nThread = 1; nThread < nThreads; ++nThread)
+    devices.append(m_workerDevices[nThread - 1].get());
+  TileRenderer renderer;
+  renderer.m_pDevices  = devices.getPtr();
+  renderer.m_rcOverall = m_rcOverall;
+  renderer.m_pTiles    = pTiles;
+  renderer.m_pImages   = images.asArrayPtr();
+  if (pThreadPool.isNull())
+  {
+    odrxThreadPoolLoop(NULL, 1, nTiles, renderer);
+    return;
+  }
+
+  // devices share the database, so it is switched into multithreaded rendering mode for the time of update
+  MtRenderGuard mtRender(m_pDevice->userGiContext() ? m_pDevice->userGiContext()->database() : NULL, m_bMtRenderOn);
+  odrxThreadPoolLoop(pThreadPool.get(), nThreads, nTiles, renderer, ThreadsCounter::kMtRegenAttributes);
+}
+
+static OdGiRasterImagePtr regenDeviceTile(OdGsDevice* pDevice, const OdGsDCRect& m_rcOverall, const OdGsDCRect& rcTile)
 {
   // check that rects have the same orientation
   ODA_ASSERT((rcTile.m_min.x < rcTile.m_max.x)==(m_rcOverall.m_min.x < m_rcOverall.m_max.x) &&
@@ -100,13 +210,13 @@ OdGiRasterImagePtr BmpTilesGen::regenTile(const OdGsDCRect& rcTile)
     std::swap(dcrc.m_min.y, dcrc.m_max.y);
   }
   */
-  m_pDevice->onSize(dcrc);
-  int n = m_pDevice->numViews();
+  pDevice->onSize(dcrc);
+  int n = pDevice->numViews();
   for(int i=0; i<n; ++i)
   {
-    m_pDevice->viewAt(i)->setViewport(rcVp);
+    pDevice->viewAt(i)->setViewport(rcVp);
   }
-  m_pDevice->update();
+  pDevice->update();
 
-  return m_pDevice->properties()->getAt(L"RasterImage");
+  return pDevice->properties()->getAt(L"RasterImage");
 }
@@ -39,6 +39,8 @@ class BmpTilesGen
 {
   OdGsDevicePtr m_pDevice;
   OdGsDCRect    m_rcOverall;
+  OdArray<OdGsDevicePtr> m_workerDevices;
+  bool          m_bMtRenderOn;
 public:
   BmpTilesGen();
   /** \param pDevice [in]  Pointer to the display device.
@@ -57,6 +59,39 @@ public:
     Returns a SmartPointer to the RasterImage.
   */
   OdGiRasterImagePtr regenTile(const OdGsDCRect& dcTile);
+  /** \details
+    Adds an extra device used by regenTiles() to render tiles concurrently.
+    \param pDevice [in]  Pointer to the display device.
+    \remarks
+    The device must be set up like the one passed to init() (same database, views, GS model
+    and properties), so it renders tiles identical to regenTile().
+  */
+  void addWorkerDevice(OdGsDevice* pDevice);
+  /** \details
+    Removes all devices added by addWorkerDevice().
+  */
+  void clearWorkerDevices();
+  /** \details
+    Tells whether the database is already in multithreaded rendering mode.
+    \param bOn [in]  true if the caller switched multithreaded rendering on itself.
+    \remarks
+    regenTiles() switches multithreaded rendering on for the time of a concurrent update and
+    off afterwards, unless it is declared to be on already. False by default.
+  */
+  void setMultiThreadedRenderOn(bool bOn);
+  /** \details
+    Regenerates the specified DeviceCoordinate rectangles, each device renders in a separate thread
+    and takes the next unrendered tile when it is done.
+    \param pTiles [in]  Array of Device Coordinate rectangles.
+    \param nTiles [in]  Number of rectangles.
+    \param images [out]  Receives raster images, in order of pTiles.
+    \param nMaxThreads [in]  Maximal number of threads to use (0 - one per device).
+    \remarks
+    Tiles are rendered serially by the init() device if no worker devices were added or
+    the thread pool module is not available. After all threads finished, the error of the first
+    failed tile is rethrown.
+  */
+  void regenTiles(const OdGsDCRect* pTiles, OdUInt32 nTiles, OdArray<OdGiRasterImagePtr>& images, OdUInt32 nMaxThreads = 0);
 };
 
 #include "TD_PackPop.h"
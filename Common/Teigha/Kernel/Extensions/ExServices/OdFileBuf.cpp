@@ -675,6 +675,11 @@ OdUInt64 OdWrFileBuf::length()
   }
 #endif
 
+#ifdef OD_RDFILEBUF_MMAP
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
 #ifdef OD_NEED_S_ISDIR_FUNC
 inline bool S_ISDIR (unsigned short mode) {return ((mode & _S_IFDIR) != 0);}
 #endif
@@ -983,6 +988,10 @@ OdRdFileBuf::OdRdFileBuf()
 
 void OdRdFileBuf::init()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  m_pFileMap = NULL;
+  m_MapPos = 0;
+#endif
   for (int i = 0; i < NUM_BUFFERS; i++)
   {
     m_DataBlock[i].buf = NULL;
@@ -992,8 +1001,42 @@ void OdRdFileBuf::init()
   }
 }
 
+#ifdef OD_RDFILEBUF_MMAP
+bool OdRdFileBuf::mapFile()
+{
+  // Only regular files could be mapped, pipes and devices are read through buffers
+  int fd = fileno(m_fp);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || OdUInt64(st.st_size) != m_length)
+    return false;
+  if (OdUInt64(size_t(m_length)) != m_length)
+    return false;
+  void* pMap = ::mmap(NULL, size_t(m_length), PROT_READ, MAP_PRIVATE, fd, 0);
+  if (pMap == MAP_FAILED)
+    return false;
+  // Drawing loading seeks a lot, so ask kernel to start reading whole file in advance
+  ::madvise(pMap, size_t(m_length), MADV_WILLNEED);
+  m_pFileMap = (OdUInt8*)pMap;
+  m_MapPos = 0;
+  return true;
+}
+
+void OdRdFileBuf::unmapFile()
+{
+  if (m_pFileMap)
+  {
+    ::munmap(m_pFileMap, size_t(m_length));
+    m_pFileMap = NULL;
+  }
+  m_MapPos = 0;
+}
+#endif
+
 void OdRdFileBuf::close()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  unmapFile();
+#endif
   // indicate buffers no longer in use
   for (int i = 0; i < NUM_BUFFERS; i++)
   {
@@ -1026,6 +1069,10 @@ void OdRdFileBuf::open(
 	  m_length = FTELL(m_fp);
     FSEEK(m_fp, OFFSETTYPE(curLoc), 0);
 
+#ifdef OD_RDFILEBUF_MMAP
+    if (m_length > 0 && mapFile())
+      return;
+#endif
     if (m_length > 0)
     {
       m_BufBytes= 0;
@@ -1138,6 +1185,27 @@ bool OdRdFileBuf::filbuf( )
 
 OdUInt64 OdRdFileBuf::seek(OdInt64 offset, OdDb::FilerSeekType whence)
 {
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+  {
+    switch (whence)
+    {
+    case OdDb::kSeekFromStart:
+      if( offset < 0 ) throw OdError_FileException(eFileInternalErr, m_FileName);
+      m_MapPos = offset;
+      break;
+    case OdDb::kSeekFromCurrent:
+      if( offset < 0 && m_MapPos < (OdUInt64)(-offset) ) throw OdError_FileException(eFileInternalErr, m_FileName);
+      m_MapPos += offset;
+      break;
+    case OdDb::kSeekFromEnd:
+      if( offset < 0 && m_length < (OdUInt64)(-offset) ) throw OdError_FileException(eFileInternalErr, m_FileName);
+      m_MapPos = m_length + offset;
+      break;
+    }
+    return m_MapPos;
+  }
+#endif
   int bytestoadvance;
 
   switch (whence)
@@ -1178,12 +1246,20 @@ OdUInt64 OdRdFileBuf::seek(OdInt64 offset, OdDb::FilerSeekType whence)
 
 OdUInt64 OdRdFileBuf::tell()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+    return m_MapPos;
+#endif
   return (m_BufPos + (m_pNextChar - m_pCurBuf));
 }
 
 
 bool OdRdFileBuf::isEof()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+    return m_MapPos >= m_length;
+#endif
   if (m_BytesLeft > 0)
     return false;
   if (m_length == 0)
@@ -1195,6 +1271,14 @@ bool OdRdFileBuf::isEof()
 
 OdUInt8 OdRdFileBuf::getByte()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+  {
+    if (m_MapPos >= m_length)
+      throw OdError(eEndOfFile);
+    return m_pFileMap[m_MapPos++];
+  }
+#endif
   m_DataBlock[m_UsingBlock].counter=m_Counter++;
   if (m_BytesLeft<=0) {
     m_BufPos+=m_BufBytes;
@@ -1213,6 +1297,16 @@ void OdRdFileBuf::getBytes(void* buffer, OdUInt32 nLen)
   OdUInt16 bytestoread;
   unsigned char *buf=(unsigned char *)buffer;
 
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+  {
+    if (m_MapPos + nLen > m_length)
+      throw OdError(eEndOfFile);
+    ::memcpy(buf, m_pFileMap + m_MapPos, nLen);
+    m_MapPos += nLen;
+    return;
+  }
+#endif
   if (nLen > 0)
   {
     m_DataBlock[m_UsingBlock].counter=m_Counter++;
@@ -1235,6 +1329,10 @@ void OdRdFileBuf::getBytes(void* buffer, OdUInt32 nLen)
 
 void OdRdFileBuf::truncate()
 {
+#ifdef OD_RDFILEBUF_MMAP
+  if (memBufferUsed())
+    throw OdError_FileException(eFileWriteError, m_FileName);
+#endif
   init();
   OdBaseFileBuf::truncate();
 
@@ -1242,6 +1340,38 @@ void OdRdFileBuf::truncate()
     throw OdError_FileException(eFileWriteError, m_FileName);
 }
 
+#ifdef OD_RDFILEBUF_MMAP
+void OdRdFileBuf::copyDataTo(OdStreamBuf* pDest, OdUInt64 nSrcStart, OdUInt64 nSrcEnd)
+{
+  if (!memBufferUsed())
+  {
+    OdBaseFileBuf::copyDataTo(pDest, nSrcStart, nSrcEnd);
+    return;
+  }
+
+  if( !pDest ) throw OdError_FileException(eNullObjectPointer, m_FileName);
+
+  if (nSrcStart == 0 && nSrcEnd == 0)
+  {
+    nSrcStart = tell();
+    nSrcEnd = length();
+  }
+  // Do nothing if incorrect positions passed
+  if( nSrcEnd <= nSrcStart ) return;
+
+  if( nSrcEnd > m_length ) throw OdError_FileException(eEndOfFile, m_FileName);
+
+  // Write directly from mapped memory, splitting on OdUInt32 boundary
+  for (OdUInt64 nPos = nSrcStart; nPos < nSrcEnd; )
+  {
+    OdUInt32 nChunk = OdUInt32(odmin(nSrcEnd - nPos, OdUInt64(0x80000000)));
+    pDest->putBytes(m_pFileMap + nPos, nChunk);
+    nPos += nChunk;
+  }
+  m_MapPos = nSrcEnd;
+}
+#endif
+
 void OdWrFileBuf::open(const OdString& filename,
                        Oda::FileShareMode shareMode,
                        Oda::FileAccessMode accessMode,
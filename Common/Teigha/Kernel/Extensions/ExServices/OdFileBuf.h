@@ -521,6 +521,11 @@ public:
 
 #define NUM_BUFFERS 8
 
+// Regular files are read through memory mapping, pipes and special files through buffers
+#if defined(__linux__) && !defined(OD_RDFILEBUF_NO_MMAP)
+#define OD_RDFILEBUF_MMAP
+#endif
+
 class OdRdFileBuf;
 typedef OdSmartPtr<OdRdFileBuf> OdRdFileBufPtr;
 
@@ -568,8 +573,19 @@ public:
   virtual void      putByte(OdUInt8 value) { ODA_FAIL();  throw OdError(eNotApplicable); };
   virtual void      putBytes(const void* buffer, OdUInt32 numBytes) { ODA_FAIL();  throw OdError(eNotApplicable); };
   virtual void      truncate();
+#ifdef OD_RDFILEBUF_MMAP
+  virtual void      copyDataTo(OdStreamBuf* pDestination, OdUInt64 sourceStart = 0, OdUInt64 sourceEnd = 0);
+#endif
 
 protected:
+#ifdef OD_RDFILEBUF_MMAP
+  OdUInt8*  m_pFileMap;    /* mapped file contents, NULL if buffers are used */
+  OdUInt64  m_MapPos;      /* position in mapped file */
+
+  inline bool memBufferUsed() const { return m_pFileMap != 0; }
+  bool mapFile();
+  void unmapFile();
+#endif
   struct blockstru
   {
     OdUInt8*  buf;        /* this buffer */
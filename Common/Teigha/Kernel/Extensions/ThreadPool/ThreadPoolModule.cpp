@@ -35,6 +35,7 @@
 #define STL_USING_ALGORITHM
 #include "OdaSTL.h"
 #include <queue>
+#include <deque>
 #ifdef _WIN32
 #include <process.h>
 #endif
@@ -1140,11 +1141,22 @@ public:
     // Saved Id's for completed threads
     typedef OdVector<unsigned, OdMemoryAllocator<unsigned> > OdUnsignedVector;
     OdUnsignedVector          m_completedThreads;
+    // Per-thread work deques. Used when all locked threads are busy: instead of blocking the caller
+    // entries are queued for the busy threads, which run own entries (LIFO) and steal others (FIFO).
+    struct WorkDeque {
+      OdMutex                   m_lock;
+      std::deque<QueueEntry*>   m_entries;
+    };
+    OdVector<OdSharedPtr<WorkDeque> > m_workDeques;
+    OdRefCounter              m_nQueuedEntries;
+    OdUInt32                  m_nNextDeque;
   public:
     MTQueue() {
       numEntries = 0;
       m_nThreadAttributes = ThreadsCounter::kNoAttributes;
       m_nFlags = 0;
+      m_nQueuedEntries = 0;
+      m_nNextDeque = 0;
     }
 
     ~MTQueue() {
@@ -1174,9 +1186,62 @@ public:
         } while (--numThreads);
       }
       SETBIT(m_nFlags, kThreadsLocked, !m_queueThreads.isEmpty());
+      if (m_queueThreads.size() > 1)
+      { // Stealing requires at least two threads
+        m_workDeques.resize(m_queueThreads.size());
+        for (OdUInt32 nDeque = 0; nDeque < m_workDeques.size(); nDeque++)
+          m_workDeques[nDeque] = new WorkDeque;
+      }
+    }
+
+    // Returns work deque index of the calling thread
+    OdUInt32 ownWorkDeque() const {
+      const unsigned threadId = OD_TP_ID_TO_UINT(OdTP::currentThreadId());
+      for (OdUInt32 nThread = 0; nThread < m_queueThreads.size(); nThread++)
+      {
+        if (getPtr(m_queueThreads[nThread])->getId() == threadId)
+          return nThread;
+      }
+      return 0;
+    }
+
+    // Pops entry from own work deque, or steals oldest entry from other deques
+    QueueEntry* popWorkEntry(OdUInt32 nOwnDeque) {
+      if (!m_nQueuedEntries)
+        return NULL;
+      const OdUInt32 nDeques = m_workDeques.size();
+      for (OdUInt32 nDeque = 0; nDeque < nDeques; nDeque++)
+      {
+        WorkDeque &deque = *m_workDeques[(nOwnDeque + nDeque) % nDeques];
+        OdMutexAutoLock lock( deque.m_lock );
+        if (!deque.m_entries.empty())
+        {
+          QueueEntry* queueEntry;
+          if (!nDeque)
+            queueEntry = deque.m_entries.back(), deque.m_entries.pop_back();
+          else
+            queueEntry = deque.m_entries.front(), deque.m_entries.pop_front();
+          --m_nQueuedEntries;
+          return queueEntry;
+        }
+      }
+      return NULL;
+    }
+
+    // Must be called under readyMutex, so busy threads can't leave the queue until entry is pushed
+    void pushWorkEntry(QueueEntry* queueEntry) {
+      WorkDeque &deque = *m_workDeques[m_nNextDeque++ % m_workDeques.size()];
+      OdMutexAutoLock lock( deque.m_lock );
+      deque.m_entries.push_back(queueEntry);
+      ++m_nQueuedEntries;
     }
     void setBusy() {
       OdMutexAutoLock lock( readyMutex );
+      setBusyLocked();
+    }
+
+    // Must be called under readyMutex
+    void setBusyLocked() {
       if ( !numEntries ) {
         ready.reset();
         // Top-level tasks require special handling, we assume that this is top-level task if no started threads registered
@@ -1198,9 +1263,9 @@ public:
       ++numEntries;
     }
 
-    void setReady(bool bMainThreadCall = false) {
+    void setReady(bool bMainThreadCall = false, OdInt32 nStolenEntries = 0) {
       OdMutexAutoLock lock( readyMutex );
-      --numEntries;
+      numEntries -= 1 + nStolenEntries;
       if (!bMainThreadCall)
       {
         /* Store completed threads in following form:
@@ -1341,6 +1406,11 @@ public:
 
     // OdApcAtom override for MTQueue
     void apcEntryPoint( OdApcParamType param ) {
+      if (!m_workDeques.isEmpty())
+      {
+        runWorkEntries(reinterpret_cast< QueueEntry* >( param ));
+        return;
+      }
       odThreadsCounter().startThread();
       QueueEntry* queueEntry = reinterpret_cast< QueueEntry* >( param );
       try { queueEntry->asyncCall(); }
@@ -1356,6 +1426,36 @@ public:
       setReady();
     }
 
+    // Runs passed entry, after that drains work deques before thread returns to the queue
+    void runWorkEntries( QueueEntry* queueEntry ) {
+      odThreadsCounter().startThread();
+      const OdUInt32 nOwnDeque = ownWorkDeque();
+      OdTP::ExceptionHandler exception;
+      OdInt32 nStolenEntries = 0;
+      for (;;)
+      {
+        try { queueEntry->asyncCall(); }
+        catch (const OdError &odError) { if (!exception.hasException()) exception.holdException(odError); }
+        catch (const std::exception &stdError) { if (!exception.hasException()) exception.holdException(stdError); }
+        catch (...) { if (!exception.hasException()) exception.holdException(); }
+        delete queueEntry;
+        queueEntry = popWorkEntry(nOwnDeque);
+        if (!queueEntry)
+        {
+          OdMutexAutoLock lock( readyMutex );
+          queueEntry = popWorkEntry(nOwnDeque);
+          if (!queueEntry)
+          {
+            odThreadsCounter().stopThread();
+            setReady(false, nStolenEntries);
+            break;
+          }
+        }
+        nStolenEntries++;
+      }
+      exception.processException();
+    }
+
     void addEntryPoint( OdApcAtom* atom, OdRxObject* rxPtrParam ) {
       addEntryPoint( new QueueEntry( atom, rxPtrParam ) );
     }
@@ -1472,9 +1572,27 @@ public:
     }
 
     inline void addEntryPoint( QueueEntry* queueEntry ) {
-      setBusy();
       // Grab free thread
       OdApcThreadImpl* thread = NULL;
+      if (!m_workDeques.isEmpty())
+      { // Entry accounting and thread grab share one lock
+        { OdMutexAutoLock lock( readyMutex );
+          setBusyLocked();
+          thread = readyThread();
+          if (!thread)
+          { // All queue threads are busy, one of them will pick up this entry
+            pushWorkEntry(queueEntry);
+            return;
+          }
+        }
+#ifndef __BORLANDC__
+        thread->asyncProcCall( static_cast<OdApcAtom*> ( this ), reinterpret_cast< OdApcParamType >( queueEntry ) );
+#else
+        thread->asyncProcCall( dynamic_cast<OdApcAtom*> ( this ), reinterpret_cast< OdApcParamType >( queueEntry ) );
+#endif
+        return;
+      }
+      setBusy();
       for (;;)
       {
         thread = readyThread();
@@ -0,0 +1,131 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2018, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Teigha(R) software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Teigha(R) Copyright (C) 2002-2018 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ODRXTHREADPOOLLOOP_INCLUDED_
+#define _ODRXTHREADPOOLLOOP_INCLUDED_ /* { Secret } **/
+
+#include "TD_PackPush.h"
+
+#include "RxThreadPoolService.h"
+#include "RxObjectImpl.h"
+#include "OdMutex.h"
+#include "OdError.h"
+
+/** \details
+    Worker of odrxThreadPoolLoop(). Takes the next unprocessed item and calls the loop body
+    with it until all items are taken. The first error stops the worker.
+    <group OdApc_Classes>
+*/
+template <class TBody>
+class OdRxThreadPoolLoopWorker : public OdApcAtom
+{
+public:
+  TBody*        m_pBody;
+  OdRefCounter* m_pNextItem;
+  OdUInt32      m_nItems;
+  OdUInt32      m_nThread;
+  OdUInt32      m_nFailedItem;
+  OdResult      m_error;
+
+  void apcEntryPoint( OdApcParamType )
+  {
+    OdUInt32 nItem = 0;
+    try
+    {
+      while ( (nItem = (OdUInt32)(++(*m_pNextItem))) < m_nItems )
+        (*m_pBody)( nItem, m_nThread );
+    }
+    catch ( const OdError& err )
+    {
+      m_error = err.code();
+      m_nFailedItem = nItem;
+    }
+    catch ( ... )
+    {
+      m_error = eExtendedError;
+      m_nFailedItem = nItem;
+    }
+  }
+};
+
+/** \details
+    Calls body( nItem, nThread ) for every item from 0 to nItems - 1 using up to nThreads
+    threads of the pool. Threads take items in increasing order, one at a time, so uneven
+    items are balanced. nThread is the index (less than nThreads) of the calling thread,
+    a thread index is never used by two threads at once, so it can select per-thread data.
+
+    \param pThreadPool [in]  Thread pool service, NULL calls body on this thread.
+    \param nThreads [in]  Maximum number of threads.
+    \param nItems [in]  Number of items.
+    \param body [in]  Functor with operator ()( OdUInt32 nItem, OdUInt32 nThread ).
+    \param nThreadAttributes [in]  Set of the attributes for the threads to run.
+
+    \remarks
+    Error thrown by body stops its thread, other threads complete their items. After all
+    threads finished, error of the lowest failed item is thrown as OdError, so it doesn't
+    depend on the thread count. Exceptions other than OdError are thrown as eExtendedError.
+*/
+template <class TBody>
+void odrxThreadPoolLoop( OdRxThreadPoolService* pThreadPool, OdUInt32 nThreads, OdUInt32 nItems, TBody& body,
+                         unsigned nThreadAttributes = ThreadsCounter::kNoAttributes )
+{
+  if ( nThreads > nItems )
+    nThreads = nItems;
+  if ( !pThreadPool || nThreads < 2 )
+  {
+    for ( OdUInt32 nItem = 0; nItem < nItems; ++nItem )
+      body( nItem, 0 );
+    return;
+  }
+  typedef OdRxThreadPoolLoopWorker<TBody> Worker;
+  OdRefCounter nNextItem;
+  nNextItem = -1;
+  OdArray<OdSmartPtr<Worker> > workers;
+  workers.reserve( nThreads );
+  OdApcQueuePtr pQueue = pThreadPool->newMTQueue( nThreadAttributes, (int)nThreads );
+  for ( OdUInt32 nThread = 0; nThread < nThreads; ++nThread )
+  {
+    workers.append( OdRxObjectImpl<Worker>::createObject() );
+    Worker& worker = *workers.last();
+    worker.m_pBody = &body;
+    worker.m_pNextItem = &nNextItem;
+    worker.m_nItems = nItems;
+    worker.m_nThread = nThread;
+    worker.m_nFailedItem = nItems;
+    worker.m_error = eOk;
+    pQueue->addEntryPoint( &worker, (OdApcParamType)0 );
+  }
+  pQueue->wait();
+  const Worker* pFailed = NULL;
+  for ( OdUInt32 nThread = 0; nThread < nThreads; ++nThread )
+  {
+    if ( workers[nThread]->m_error != eOk && ( !pFailed || workers[nThread]->m_nFailedItem < pFailed->m_nFailedItem ) )
+      pFailed = workers[nThread].get();
+  }
+  if ( pFailed )
+    throw OdError( pFailed->m_error );
+}
+
+#include "TD_PackPop.h"
+
+#endif //_ODRXTHREADPOOLLOOP_INCLUDED_
@@ -30,6 +30,30 @@
 /*                                                                      */
 /*    OdPdfExportEx <source file> <target file> <options>               */
 /*                                                                      */
+/* Batch mode converts a list of files with one initialization:         */
+/*                                                                      */
+/*    OdPdfExportEx -batch <list file | -> [<worker threads>]           */
+/*                                                                      */
+/* Each list line holds <source file><TAB><target file>, "-" reads the  */
+/* list from standard input.                                            */
+/*                                                                      */
+/* Benchmark mode exports every listed file with each built-in profile  */
+/* and prints the export time (best of <runs>, default 3) and PDF size. */
+/* The profile name is added to each target name:                       */
+/*                                                                      */
+/*    OdPdfExportEx -bench <list file | -> [<runs>]                     */
+/*                                                                      */
+/* Export options (also accepted in batch and benchmark modes after the */
+/* list, in benchmark mode they are applied over each profile):         */
+/*                                                                      */
+/*    -profile <default|fast-web>   built-in parameter profile          */
+/*    -config <file>                key=value lines with options below  */
+/*    -geomdpi <n> -imagedpi <n> -bwdpi <n>                             */
+/*    -hlr <on|off> -compress <on|off> -textgeom <on|off>               */
+/*    -linearize <on|off>           linearized PDF for fast web view    */
+/*    -color <gray|mono|none> -page <a4|extents|<w>x<h>>                */
+/*    -shxcache <file>              keep SHX glyph cache in the file    */
+/*                                                                      */
 /************************************************************************/
 
 
@@ -41,6 +65,8 @@
 #include <stdlib.h>
 #include <algorithm>
 #include <locale.h>
+#include <fstream>
+#include <vector>
 
 #define STL_USING_IOSTREAM
 #include "OdaSTL.h"
@@ -55,6 +81,10 @@
 #include "DbBlockTableRecord.h"
 #include "DbDictionary.h"
 #include "DbPlotSettingsValidator.h"
+#include "RxThreadPoolLoop.h"
+#include "OdModuleNames.h"
+#include "OdMutex.h"
+#include "OdPerfTimer.h"
 
 #include "PdfExport.h"
 
@@ -115,8 +145,527 @@ ODRX_END_STATIC_MODULE_MAP()
 //----------------------------------------------------------------------------------
 
 
-void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdStreamBufPtr& pBuffer);
-void SetPdfExportParam(PDFExportParams& params, OdDgDatabasePtr& pDb, const OdStreamBufPtr& pBuffer);
+/************************************************************************/
+/* Export parameters profile                                            */
+/************************************************************************/
+struct PdfExportProfile
+{
+	enum PageSizing
+	{
+		kPageClampA4,   // drawing extents clamped by A4 sheet
+		kPageExtents,   // drawing extents as is
+		kPageFixed      // m_dPageWidth x m_dPageHeight
+	};
+
+	int nSolidHatchExpType;
+	int nOtherHatchExpType;
+	bool bZoomToExtents;
+	bool bEmbededTTF;
+	bool bEmbededOptimizedTTF;
+	bool bTTFAsAGeometry;
+	bool bSHXAsAGeometry;
+	bool bEncoded;
+	bool bUseHiddenLineAlgo;
+	bool bUseSimpleGeomOpt;
+	bool bSearchableTTF;
+	bool bSearchableSHX;
+	bool bLinearized;
+	OdUInt16 iGeomRes;
+	OdUInt16 iColorRes;
+	OdUInt16 iBWRes;
+	PDFExportParams::ColorPolicy cp;
+	PageSizing pageSizing;
+	double dPageWidth;
+	double dPageHeight;
+	string sShxCacheFile; // not a part of profiles
+
+	PdfExportProfile()
+	{
+		setDefault();
+	}
+
+	// Output quality settings, used if no profile specified
+	void setDefault()
+	{
+		nSolidHatchExpType = 2;
+		nOtherHatchExpType = 1;
+		bZoomToExtents = true;
+		bEmbededTTF = false;
+		bEmbededOptimizedTTF = false;
+		bTTFAsAGeometry = true;
+		bSHXAsAGeometry = true;
+		bEncoded = true;
+		bUseHiddenLineAlgo = true;
+		bUseSimpleGeomOpt = true;
+		bSearchableTTF = true;
+		bSearchableSHX = true;
+		bLinearized = false;
+		iGeomRes = 4800;
+		iColorRes = 600;
+		iBWRes = 4800;
+		cp = PDFExportParams::kGrayscale;
+		pageSizing = kPageClampA4;
+		dPageWidth = 297.;
+		dPageHeight = 210.;
+	}
+
+	// Throughput and output size over fidelity: no HLR, low resolutions, text kept as text
+	void setFastWeb()
+	{
+		setDefault();
+		bTTFAsAGeometry = false;
+		bSearchableSHX = false;
+		bUseHiddenLineAlgo = false;
+		iGeomRes = 600;
+		iColorRes = 150;
+		iBWRes = 300;
+		pageSizing = kPageExtents;
+	}
+
+	bool setProfile(const string& name)
+	{
+		if (name == "default")
+			setDefault();
+		else if (name == "fast-web")
+			setFastWeb();
+		else
+			return false;
+		return true;
+	}
+
+	bool setOption(const string& key, const string& value);
+	bool loadConfig(const OdString& fileName);
+	// Parses options starting from argv[nFirst], returns false on invalid option
+	template <class CharType>
+	bool parseArgs(int argc, CharType* argv[], int nFirst)
+	{
+		for (int nArg = nFirst; nArg < argc; nArg++)
+		{
+			string key = (const char*)OdString(argv[nArg]);
+			if (key.empty() || key[0] != '-' || nArg + 1 >= argc)
+			{
+				STD(cout) << "Invalid option: " << key << STD(endl);
+				return false;
+			}
+			string value = (const char*)OdString(argv[++nArg]);
+			key.erase(0, 1);
+			if (key == "config")
+			{
+				if (!loadConfig(OdString(value.c_str())))
+					return false;
+			}
+			else if (!setOption(key, value))
+				return false;
+		}
+		return true;
+	}
+
+	void apply(PDFExportParams& params) const;
+	void setPageSize(PDFExportParams& params, double width, double height) const;
+};
+
+static bool parseSwitch(const string& value, bool& bOut)
+{
+	if (value == "on" || value == "1" || value == "true")
+		bOut = true;
+	else if (value == "off" || value == "0" || value == "false")
+		bOut = false;
+	else
+		return false;
+	return true;
+}
+
+static bool parseDPI(const string& value, OdUInt16& nOut)
+{
+	int nDPI = atoi(value.c_str());
+	if (nDPI < 72 || nDPI > 40000)
+		return false;
+	nOut = (OdUInt16)nDPI;
+	return true;
+}
+
+bool PdfExportProfile::setOption(const string& key, const string& value)
+{
+	bool bValid = true;
+	if (key == "profile")
+		bValid = setProfile(value);
+	else if (key == "geomdpi")
+		bValid = parseDPI(value, iGeomRes);
+	else if (key == "imagedpi")
+		bValid = parseDPI(value, iColorRes);
+	else if (key == "bwdpi")
+		bValid = parseDPI(value, iBWRes);
+	else if (key == "hlr")
+		bValid = parseSwitch(value, bUseHiddenLineAlgo);
+	else if (key == "compress")
+		bValid = parseSwitch(value, bEncoded);
+	else if (key == "linearize")
+		bValid = parseSwitch(value, bLinearized);
+	else if (key == "textgeom")
+	{
+		bValid = parseSwitch(value, bTTFAsAGeometry);
+		bSHXAsAGeometry = bTTFAsAGeometry;
+	}
+	else if (key == "color")
+	{
+		if (value == "gray")
+			cp = PDFExportParams::kGrayscale;
+		else if (value == "mono")
+			cp = PDFExportParams::kMono;
+		else if (value == "none")
+			cp = PDFExportParams::kNoPolicy; // native palette
+		else
+			bValid = false;
+	}
+	else if (key == "shxcache")
+		sShxCacheFile = value;
+	else if (key == "page")
+	{
+		double width = 0., height = 0.;
+		if (value == "a4")
+			pageSizing = kPageClampA4, dPageWidth = 297., dPageHeight = 210.;
+		else if (value == "extents")
+			pageSizing = kPageExtents;
+		else if (sscanf(value.c_str(), "%lfx%lf", &width, &height) == 2 && width > 0. && height > 0.)
+			pageSizing = kPageFixed, dPageWidth = width, dPageHeight = height;
+		else
+			bValid = false;
+	}
+	else
+	{
+		STD(cout) << "Unknown option: " << key << STD(endl);
+		return false;
+	}
+	if (!bValid)
+		STD(cout) << "Invalid value of " << key << ": " << value << STD(endl);
+	return bValid;
+}
+
+bool PdfExportProfile::loadConfig(const OdString& fileName)
+{
+	std::ifstream config((const char*)fileName);
+	if (!config)
+	{
+		STD(cout) << "Can't open config: " << (const char*)fileName << STD(endl);
+		return false;
+	}
+	string line;
+	while (getline(config, line))
+	{
+		size_t nFirst = line.find_first_not_of(" \t");
+		if (nFirst == string::npos || line[nFirst] == '#')
+			continue;
+		size_t nEq = line.find('=');
+		if (nEq == string::npos)
+		{
+			STD(cout) << "Invalid config line: " << line << STD(endl);
+			return false;
+		}
+		string key = line.substr(nFirst, nEq - nFirst), value = line.substr(nEq + 1);
+		key.erase(key.find_last_not_of(" \t\r") + 1);
+		value.erase(0, value.find_first_not_of(" \t"));
+		value.erase(value.find_last_not_of(" \t\r") + 1);
+		if (!setOption(key, value))
+			return false;
+	}
+	return true;
+}
+
+void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdStreamBufPtr& pBuffer, const PdfExportProfile& profile);
+void SetPdfExportParam(PDFExportParams& params, OdDgDatabasePtr& pDb, const OdStreamBufPtr& pBuffer, const PdfExportProfile& profile);
+
+// Serializes console output of batch workers
+static OdMutex g_outputMutex;
+
+enum InputType
+{
+	kInputUnknown,
+	kInputDwg,
+	kInputDgn
+};
+
+static InputType inputType(const OdString& inputFile)
+{
+	if (inputFile.getLength() < 4)
+		return kInputUnknown;
+	wstring ext = inputFile.right(4).c_str();
+	transform(ext.begin(), ext.end(), ext.begin(), towlower);
+	if (ext.compare(L".dwg") == 0 || ext.compare(L".dxf") == 0)
+		return kInputDwg;
+	if (ext.compare(L".dgn") == 0)
+		return kInputDgn;
+	return kInputUnknown;
+}
+
+// Measured by ExportFile for the benchmark mode
+struct ExportStats
+{
+	double dExportSec;   // exportPdf() only, drawing loading isn't included
+	OdUInt64 nPdfSize;
+};
+
+/************************************************************************/
+/* Exports a single file, errors are reported and don't propagate       */
+/************************************************************************/
+static bool ExportFile(const OdString& inputFile, const OdString& outputFile, MyDwgServices& dwgSvcs, MyDgnServices& dgnSvcs, PdfExportModule* pModule,
+                       const PdfExportProfile& profile, ExportStats* pStats = NULL)
+{
+	try
+	{
+		OdPdfExportPtr exporter = pModule->create();
+		OdStreamBufPtr pBuffer = odSystemServices()->createFile(outputFile.c_str(), Oda::kFileWrite, Oda::kShareDenyNo, Oda::kCreateAlways);
+		PDFExportParams params;
+		OdUInt32 errCode;
+		OdPerfTimerWrapper timer;
+
+		if (inputType(inputFile) == kInputDwg)
+		{
+			OdDbDatabasePtr pDb = dwgSvcs.readFile(inputFile);
+			SetPdfExportParam(params, pDb, pBuffer, profile);
+			timer.getTimer()->start();
+			errCode = exporter->exportPdf(params);
+			timer.getTimer()->stop();
+		}
+		else
+		{
+			OdDgDatabasePtr pDb = dgnSvcs.readFile(inputFile);
+			SetPdfExportParam(params, pDb, pBuffer, profile);
+			timer.getTimer()->start();
+			errCode = exporter->exportPdf(params);
+			timer.getTimer()->stop();
+		}
+		if (pStats)
+		{
+			pStats->dExportSec = timer.getTimer()->countedSec();
+			pStats->nPdfSize = pBuffer->length();
+		}
+		if (errCode != 0)
+		{
+			OdString errMes = exporter->exportPdfErrorCode(errCode);
+			OdMutexAutoLock lock(g_outputMutex);
+			printf("\n%ls: exportPdf error returned : 0x%x. \n%s", inputFile.c_str(), (unsigned)errCode, (const char*)errMes);
+			return false;
+		}
+	}
+	catch (OdError& err)
+	{
+		OdString msg = err.description();
+		OdMutexAutoLock lock(g_outputMutex);
+		STD(cout) << (const char*)inputFile << ": Teigha Error: " << (const char*)msg << STD(endl) << STD(endl);
+		return false;
+	}
+	catch (...)
+	{
+		OdMutexAutoLock lock(g_outputMutex);
+		STD(cout) << (const char*)inputFile << ": Unknown Error." << STD(endl) << STD(endl);
+		return false;
+	}
+	return true;
+}
+
+/************************************************************************/
+/* Batch exporter, exports one list entry on any batch thread           */
+/************************************************************************/
+struct BatchEntry
+{
+	OdString m_inputFile;
+	OdString m_outputFile;
+};
+
+struct BatchExporter
+{
+	const std::vector<BatchEntry>* m_pEntries;
+	OdRefCounter* m_pFailed;
+	MyDwgServices* m_pDwgSvcs;
+	MyDgnServices* m_pDgnSvcs;
+	PdfExportModule* m_pModule;
+	const PdfExportProfile* m_pProfile;
+
+	void operator()(OdUInt32 nEntry, OdUInt32 /*nThread*/)
+	{
+		const BatchEntry& entry = (*m_pEntries)[nEntry];
+		if (!ExportFile(entry.m_inputFile, entry.m_outputFile, *m_pDwgSvcs, *m_pDgnSvcs, m_pModule, *m_pProfile))
+			++(*m_pFailed);
+	}
+};
+
+static bool ReadBatchList(istream& input, std::vector<BatchEntry>& entries)
+{
+	string line;
+	while (getline(input, line))
+	{
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+		if (line.empty() || line[0] == '#')
+			continue;
+		// Tab separates paths with spaces, otherwise the first space is used
+		size_t nSep = line.find('\t');
+		if (nSep == string::npos)
+			nSep = line.find(' ');
+		size_t nOut = (nSep == string::npos) ? nSep : line.find_first_not_of(" \t", nSep);
+		if (nOut == string::npos)
+		{
+			STD(cout) << "Invalid batch list line: " << line << STD(endl);
+			return false;
+		}
+		BatchEntry entry;
+		entry.m_inputFile = line.substr(0, nSep).c_str();
+		entry.m_outputFile = line.substr(nOut).c_str();
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+// Reads the list file (or standard input for "-"), drops unsupported files and loads the DGN module if needed
+static bool LoadBatchList(const OdString& listFile, std::vector<BatchEntry>& entries, int& nFailed)
+{
+	bool bListRead;
+	if (listFile == L"-")
+		bListRead = ReadBatchList(STD(cin), entries);
+	else
+	{
+		std::ifstream listStream((const char*)listFile);
+		if (!listStream)
+		{
+			STD(cout) << "Can't open batch list: " << (const char*)listFile << STD(endl);
+			return false;
+		}
+		bListRead = ReadBatchList(listStream, entries);
+	}
+	if (!bListRead)
+		return false;
+
+	nFailed = 0;
+	bool bDgnLoaded = false;
+	for (size_t nEntry = 0; nEntry < entries.size(); nEntry++)
+	{
+		InputType type = inputType(entries[nEntry].m_inputFile);
+		if (type == kInputUnknown)
+		{
+			STD(cout) << (const char*)entries[nEntry].m_inputFile << ": Unsupported file type." << STD(endl);
+			entries.erase(entries.begin() + nEntry--);
+			++nFailed;
+		}
+		else if (type == kInputDgn && !bDgnLoaded)
+		{
+			// Modules are loaded once by main thread, workers only use them
+			::odrxDynamicLinker()->loadModule(L"TG_Db", false);
+			bDgnLoaded = true;
+		}
+	}
+	return true;
+}
+
+static int RunBatch(const OdString& listFile, int nThreads, MyDwgServices& dwgSvcs, MyDgnServices& dgnSvcs, const PdfExportProfile& profile)
+{
+	std::vector<BatchEntry> entries;
+	int nUnsupported;
+	if (!LoadBatchList(listFile, entries, nUnsupported))
+		return -1;
+
+	const int nTotal = (int)entries.size() + nUnsupported;
+	OdRefCounter nFailed;
+	nFailed = nUnsupported;
+
+	OdPdfExportModulePtr pModule = ::odrxDynamicLinker()->loadApp(OdPdfExportModuleName);
+	// glyph cache is written back when the module is unloaded
+	setShxGlyphCacheFile(OdString(profile.sShxCacheFile.c_str()));
+	if (nThreads > (int)entries.size())
+		nThreads = (int)entries.size();
+	if (nThreads < 1)
+		nThreads = 1;
+
+	OdRxThreadPoolServicePtr pThreadPool;
+	if (nThreads > 1)
+		pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+	if (pThreadPool.isNull())
+		nThreads = 1;
+
+	BatchExporter exporter;
+	exporter.m_pEntries = &entries;
+	exporter.m_pFailed = &nFailed;
+	exporter.m_pDwgSvcs = &dwgSvcs;
+	exporter.m_pDgnSvcs = &dgnSvcs;
+	exporter.m_pModule = pModule.get();
+	exporter.m_pProfile = &profile;
+	odrxThreadPoolLoop(pThreadPool.get(), (OdUInt32)nThreads, (OdUInt32)entries.size(), exporter,
+		ThreadsCounter::kMtLoadingAttributes | ThreadsCounter::kMtRegenAttributes);
+
+	STD(cout) << nTotal - (int)nFailed << " of " << nTotal << " files exported." << STD(endl);
+	return ((int)nFailed) ? 1 : 0;
+}
+
+// "out.pdf" -> "out-fast-web.pdf"
+static OdString ProfileOutputFile(const OdString& outputFile, const char* pProfile)
+{
+	OdString sProfile(pProfile);
+	int nDot = outputFile.reverseFind(L'.');
+	int nSlash = odmax(outputFile.reverseFind(L'/'), outputFile.reverseFind(L'\\'));
+	if (nDot <= nSlash)
+		return outputFile + L"-" + sProfile;
+	return outputFile.left(nDot) + L"-" + sProfile + outputFile.mid(nDot);
+}
+
+/************************************************************************/
+/* Benchmark: exports every listed file with each built-in profile      */
+/************************************************************************/
+template <class CharType>
+static int RunBench(const OdString& listFile, int nRuns, MyDwgServices& dwgSvcs, MyDgnServices& dgnSvcs,
+                    int argc, CharType* argv[], int nFirstOption)
+{
+	static const char* profileNames[] = { "default", "fast-web" };
+	const int nProfiles = sizeof(profileNames) / sizeof(profileNames[0]);
+
+	std::vector<BatchEntry> entries;
+	int nFailed;
+	if (!LoadBatchList(listFile, entries, nFailed))
+		return -1;
+
+	// Extra options are applied over each profile
+	PdfExportProfile profiles[nProfiles];
+	for (int nProfile = 0; nProfile < nProfiles; nProfile++)
+	{
+		profiles[nProfile].setProfile(profileNames[nProfile]);
+		if (!profiles[nProfile].parseArgs(argc, argv, nFirstOption))
+			return -1;
+	}
+
+	OdPdfExportModulePtr pModule = ::odrxDynamicLinker()->loadApp(OdPdfExportModuleName);
+	setShxGlyphCacheFile(OdString(profiles[0].sShxCacheFile.c_str()));
+
+	double dTotalSec[nProfiles] = { 0. };
+	OdUInt64 nTotalSize[nProfiles] = { 0 };
+	printf("%-40s %-10s %12s %12s\n", "file", "profile", "export, ms", "PDF, bytes");
+	for (size_t nEntry = 0; nEntry < entries.size(); nEntry++)
+	{
+		const BatchEntry& entry = entries[nEntry];
+		for (int nProfile = 0; nProfile < nProfiles; nProfile++)
+		{
+			OdString outputFile = ProfileOutputFile(entry.m_outputFile, profileNames[nProfile]);
+			ExportStats best = { 0., 0 };
+			bool bExported = true;
+			for (int nRun = 0; nRun < nRuns && bExported; nRun++)
+			{
+				ExportStats stats;
+				bExported = ExportFile(entry.m_inputFile, outputFile, dwgSvcs, dgnSvcs, pModule.get(), profiles[nProfile], &stats);
+				if (bExported && (!nRun || stats.dExportSec < best.dExportSec))
+					best = stats;
+			}
+			if (!bExported)
+			{
+				++nFailed;
+				continue;
+			}
+			printf("%-40ls %-10s %12.1f %12.0f\n", entry.m_inputFile.c_str(), profileNames[nProfile], best.dExportSec * 1000., (double)best.nPdfSize);
+			dTotalSec[nProfile] += best.dExportSec;
+			nTotalSize[nProfile] += best.nPdfSize;
+		}
+	}
+	for (int nProfile = 0; nProfile < nProfiles; nProfile++)
+		printf("%-40s %-10s %12.1f %12.0f\n", "total", profileNames[nProfile], dTotalSec[nProfile] * 1000., (double)nTotalSize[nProfile]);
+
+	return nFailed ? 1 : 0;
+}
 
 #if defined(OD_USE_WMAIN)
 int wmain(int argc, wchar_t* argv[])
@@ -143,103 +692,99 @@ int main(int argc, char* argv[])
 		OdStaticRxObject<MyDgnServices> dgnSvcs;
 
 		OdString inputFile = argv[1];
-		if (inputFile.getLength() < 4)
-			return -1;
-		wstring ext = inputFile.right(4);
-		transform(ext.begin(), ext.end(), ext.begin(), towlower);
-		bool bDwg;
-		if (ext.compare(L".dwg") == 0 || ext.compare(L".dxf") == 0)
-			bDwg = true;
-		else if (ext.compare(L".dgn") == 0)
-			bDwg = false;
-		else
-			return -1;
+		if (inputFile == L"-bench")
+		{
+			int nRuns = 3, nFirstOption = 3;
+			if (argc > 3 && OdString(argv[3]).getAt(0) != L'-')
+				nRuns = odmax(1, atoi(OdString(argv[nFirstOption++])));
+			int nRes = -1;
+			try
+			{
+				nRes = RunBench(OdString(argv[2]), nRuns, dwgSvcs, dgnSvcs, argc, argv, nFirstOption);
+			}
+			catch (OdError& err)
+			{
+				OdString msg = err.description();
+				STD(cout) << "Teigha Error: " << (const char*)msg << STD(endl) << STD(endl);
+			}
+			odUninitialize();
+			return nRes;
+		}
+		if (inputFile == L"-batch")
+		{
+			// Services, modules and font caches stay initialized for all listed files
+			int nThreads = 1, nFirstOption = 3;
+			if (argc > 3 && OdString(argv[3]).getAt(0) != L'-')
+				nThreads = atoi(OdString(argv[nFirstOption++]));
+			PdfExportProfile profile;
+			if (!profile.parseArgs(argc, argv, nFirstOption))
+			{
+				odUninitialize();
+				return -1;
+			}
+			int nRes = -1;
+			try
+			{
+				nRes = RunBatch(OdString(argv[2]), nThreads, dwgSvcs, dgnSvcs, profile);
+			}
+			catch (OdError& err)
+			{
+				OdString msg = err.description();
+				STD(cout) << "Teigha Error: " << (const char*)msg << STD(endl) << STD(endl);
+			}
+			odUninitialize();
+			return nRes;
+		}
+
+		InputType type = inputType(inputFile);
 		OdString outputFile = argv[2];
+		PdfExportProfile profile;
+		if (type == kInputUnknown || !profile.parseArgs(argc, argv, 3))
+		{
+			odUninitialize();
+			return -1;
+		}
 
+		int nRes = 0;
 		try
 		{
 			OdPdfExportModulePtr pModule = ::odrxDynamicLinker()->loadApp(OdPdfExportModuleName);
-			OdPdfExportPtr exporter = pModule->create();
-			OdStreamBufPtr pBuffer = odSystemServices()->createFile(outputFile.c_str(), Oda::kFileWrite, Oda::kShareDenyNo, Oda::kCreateAlways);
-			PDFExportParams params;
-
-			if (bDwg)
-			{
-				OdDbDatabasePtr pDb = dwgSvcs.readFile(inputFile);
-				SetPdfExportParam(params, pDb, pBuffer);
-
-				OdUInt32 errCode = exporter->exportPdf(params);
-				if (errCode != 0)
-				{
-					OdString errMes = exporter->exportPdfErrorCode(errCode);
-					printf("\nexportPdf error returned : 0x%x. \n%s", (unsigned)errCode, (const char*)errMes);
-				}
-			}
-			else
-			{
+			setShxGlyphCacheFile(OdString(profile.sShxCacheFile.c_str()));
+			if (type == kInputDgn)
 				::odrxDynamicLinker()->loadModule(L"TG_Db", false);
-				OdDgDatabasePtr pDb = dgnSvcs.readFile(inputFile);
-				SetPdfExportParam(params, pDb, pBuffer);
-
-				OdUInt32 errCode = exporter->exportPdf(params);
-				if (errCode != 0)
-				{
-					OdString errMes = exporter->exportPdfErrorCode(errCode);
-					printf("\nexportPdf error returned : 0x%x. \n%s", (unsigned)errCode, (const char*)errMes);
-				}
-			}
+			if (!ExportFile(inputFile, outputFile, dwgSvcs, dgnSvcs, pModule.get(), profile))
+				nRes = 1;
 		}
 		catch (OdError& err)
 		{
 			OdString msg = err.description();
 			STD(cout) << "Teigha Error: " << (const char*)msg << STD(endl) << STD(endl);
-			return 0;
+			nRes = 1;
 		}
 		catch (...)
 		{
 			STD(cout) << "Unknown Error." << STD(endl) << STD(endl);
-			return 0;
+			nRes = 1;
 		}
 
 		odUninitialize();
+		return nRes;
 	}
 
 	return 0;
 }
 
-void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdStreamBufPtr& pBuffer)
+void PdfExportProfile::apply(PDFExportParams& params) const
 {
-	int nSolidHatchExpType = 2;
-	int nOtherHatchExpType = 1;
-	bool bZoomToExtents = true;
-	bool bEmbededTTF = false;
-	bool bEmbededOptimizedTTF = false;
-	bool bTTFAsAGeometry = true;
-	bool bSHXAsAGeometry = true;
 	bool bEnableLayersSupport = false;
 	bool bIncludeOffLayers = false;
 	bool bExtentsBoundingBox = false;
-	bool bEncoded = true;
 	bool bASCIIhexEncoded = false;
-	bool bUseHiddenLineAlgo = true;
-	bool bUseSimpleGeomOpt = true;
-	bool bSearchableTTF = true;
-	bool bSearchableSHX = true;
 	bool bHyperlinks = false;
-	bool bLinearized = false;
 	bool bMeasuring = false;
-	bool bMonoPalette = false;
-	OdUInt16 iGeomRes = 4800;
-	OdUInt16 iColorRes = 600;
-	OdUInt16 iBWRes = 4800;
-	PDFExportParams::ColorPolicy cp = PDFExportParams::kGrayscale;
 	PDFExportParams::PDF_A_mode  pdfAmode = PDFExportParams::kPDFA_None;
-	double width = 0.0f;
-	double height = 0.0f;
 
-	params.setDatabase(pDb);
 	params.setVersion(PDFExportParams::kPDFv1_5);
-	params.setOutput(pBuffer);
 	params.setExportFlags(PDFExportParams::PDFExportFlags(
 		(bEmbededTTF ? PDFExportParams::kEmbededTTF : 0) |
 		(bEmbededOptimizedTTF ? PDFExportParams::kEmbededOptimizedTTF : 0) |
@@ -287,6 +832,38 @@ void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdSt
 			break;
 		}
 	}
+}
+
+void PdfExportProfile::setPageSize(PDFExportParams& params, double width, double height) const
+{
+	OdGsPageParams pageParams; // in mm
+	switch (pageSizing)
+	{
+		case kPageExtents:
+			pageParams.set(width, height);
+			break;
+		case kPageFixed:
+			pageParams.set(dPageWidth, dPageHeight);
+			break;
+		case kPageClampA4:
+		default:
+			if (width > height)
+				pageParams.set(odmin(width, dPageWidth), odmin(height, dPageHeight));
+			else
+				pageParams.set(odmin(width, dPageHeight), odmin(height, dPageWidth));
+			break;
+	}
+	params.pageParams().push_back(pageParams);
+}
+
+void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdStreamBufPtr& pBuffer, const PdfExportProfile& profile)
+{
+	double width = 0.0f;
+	double height = 0.0f;
+
+	params.setDatabase(pDb);
+	params.setOutput(pBuffer);
+	profile.apply(params);
 
 	OdDbBlockTableRecordPtr pLayoutBlock = pDb->getActiveLayoutBTRId().safeOpenObject();
 	OdDbLayoutPtr pLayout = pLayoutBlock->getLayoutId().safeOpenObject(OdDb::kForWrite);
@@ -310,94 +887,17 @@ void SetPdfExportParam(PDFExportParams& params, OdDbDatabasePtr& pDb, const OdSt
 	else
 		pLayout->getPlotPaperSize(width, height);
 
-	OdGsPageParams pageParams; // in mm
-	if (width > height)
-		pageParams.set(min(width, 297), min(height, 210));
-	else
-		pageParams.set(min(width, 210), min(height, 297));
-	params.pageParams().push_back(pageParams);
+	profile.setPageSize(params, width, height);
 }
 
-void SetPdfExportParam(PDFExportParams& params, OdDgDatabasePtr& pDb, const OdStreamBufPtr& pBuffer)
+void SetPdfExportParam(PDFExportParams& params, OdDgDatabasePtr& pDb, const OdStreamBufPtr& pBuffer, const PdfExportProfile& profile)
 {
-	int nSolidHatchExpType = 2;
-	int nOtherHatchExpType = 1;
-	bool bZoomToExtents = true;
-	bool bEmbededTTF = false;
-	bool bEmbededOptimizedTTF = false;
-	bool bTTFAsAGeometry = true;
-	bool bSHXAsAGeometry = true;
-	bool bEnableLayersSupport = false;
-	bool bIncludeOffLayers = false;
-	bool bExtentsBoundingBox = false;
-	bool bEncoded = true;
-	bool bASCIIhexEncoded = false;
-	bool bUseHiddenLineAlgo = true;
-	bool bUseSimpleGeomOpt = true;
-	bool bSearchableTTF = true;
-	bool bSearchableSHX = true;
-	bool bHyperlinks = false;
-	bool bLinearized = false;
-	bool bMeasuring = false;
-	bool bMonoPalette = false;
-	OdUInt16 iGeomRes = 4800;
-	OdUInt16 iColorRes = 600;
-	OdUInt16 iBWRes = 4800;
-	PDFExportParams::ColorPolicy cp = PDFExportParams::kGrayscale;
-	PDFExportParams::PDF_A_mode  pdfAmode = PDFExportParams::kPDFA_None;
 	double width = 0.0f;
 	double height = 0.0f;
 
 	params.setDatabase(pDb);
-	params.setVersion(PDFExportParams::kPDFv1_5);
 	params.setOutput(pBuffer);
-	params.setExportFlags(PDFExportParams::PDFExportFlags(
-		(bEmbededTTF ? PDFExportParams::kEmbededTTF : 0) |
-		(bEmbededOptimizedTTF ? PDFExportParams::kEmbededOptimizedTTF : 0) |
-		(bTTFAsAGeometry ? PDFExportParams::kTTFTextAsGeometry : 0) |
-		(bSHXAsAGeometry ? PDFExportParams::kSHXTextAsGeometry : 0) |
-		(bEnableLayersSupport ? PDFExportParams::kEnableLayers : 0) |
-		(bIncludeOffLayers ? PDFExportParams::kIncludeOffLayers : 0) |
-		(bUseSimpleGeomOpt ? PDFExportParams::kSimpleGeomOptimization : 0) |
-		(bEncoded ? PDFExportParams::kFlateCompression : 0) |
-		(bASCIIhexEncoded ? PDFExportParams::kASCIIHexEncoding : 0) |
-		(bUseHiddenLineAlgo ? PDFExportParams::kUseHLR : 0) |
-		(bHyperlinks ? PDFExportParams::kExportHyperlinks : 0) |
-		(bLinearized ? PDFExportParams::kLinearized : 0) |
-		(bMeasuring ? PDFExportParams::kMeasuring : 0) |
-		(bZoomToExtents ? PDFExportParams::kZoomToExtentsMode : 0)));
-	params.setSearchableTextType((PDFExportParams::SearchableTextType)((bSearchableSHX ? PDFExportParams::kSHX : 0) | (bSearchableTTF ? PDFExportParams::kTTF : 0)));
-	if (!bExtentsBoundingBox)
-		SETBIT(params.m_reserved1, 1, 1);
-	params.setTitle("Batch PDF File");
-	params.setAuthor("OdPdfTestEx");
-	params.setCreator("Teigha");
-	params.setGeomDPI(iGeomRes);
-	params.setColorImagesDPI(iColorRes);
-	params.setBWImagesDPI(iBWRes);
-	params.setArchived(pdfAmode);
-	params.setOtherHatchesExportType(GETBIT(nOtherHatchExpType, 1) ? PDFExportParams::kDrawing : PDFExportParams::kBitmap);
-	if (cp != PDFExportParams::kNoPolicy)
-		params.setColorPolicy(cp);
-	switch (nSolidHatchExpType)
-	{
-		case 1: // as a drawing (vectorizer)
-		{
-			params.setSolidHatchesExportType(PDFExportParams::kDrawing);
-			break;
-		}
-		case 2: // as a pdf path
-		{
-			params.setSolidHatchesExportType(PDFExportParams::kPdfPaths);
-			break;
-		}
-		case 0: // as a bitmap
-		default:
-		{
-			params.setSolidHatchesExportType(PDFExportParams::kBitmap);
-			break;
-		}
-	}
+	profile.apply(params);
 
 	OdDgElementId activeModelId = pDb->getActiveModelId();
 	if (activeModelId.isNull())
@@ -425,10 +925,5 @@ void SetPdfExportParam(PDFExportParams& params, OdDgDatabasePtr& pDb, const OdSt
 	pModel->getGeomExtents(ext);
 	width = ext.maxPoint().x - ext.minPoint().x;
 	height = ext.maxPoint().y - ext.minPoint().y;
-	OdGsPageParams pageParams; // in mm
-	if (width > height)
-		pageParams.set(min(width, 297), min(height, 210));
-	else
-		pageParams.set(min(width, 210), min(height, 297));
-	params.pageParams().push_back(pageParams);
+	profile.setPageSize(params, width, height);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <map>
 #include <list>
+#include <unordered_map>
 #include "OdaCommon.h"
 #include "ExSystemServices.h"
 #include "ExHostAppServices.h"
@@ -43,6 +44,10 @@
 #include "DbViewport.h"
 #include "DbTextStyleTableRecord.h"
 #include "DbLayerTable.h"
+//multithreading
+#include "RxThreadPoolLoop.h"
+#include "OdModuleNames.h"
+#include "OdMutex.h"
 
 #pragma region Ԥ
 
@@ -53,6 +58,7 @@ using namespace ModelExporter;
 ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(ModelerModule);
 ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRecomputeDimBlockModule);
 ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(BitmapModule);
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRxThreadPoolImpl);
 #if defined(OD_HAS_OPENGL)
 ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(WinOpenGLModule);
 #endif
@@ -61,6 +67,7 @@ ODRX_BEGIN_STATIC_MODULE_MAP()
 ODRX_DEFINE_STATIC_APPLICATION(OdModelerGeometryModuleName, ModelerModule)
 ODRX_DEFINE_STATIC_APPLICATION(OdRecomputeDimBlockModuleName, OdRecomputeDimBlockModule)
 ODRX_DEFINE_STATIC_APPMODULE(OdWinBitmapModuleName, BitmapModule)
+ODRX_DEFINE_STATIC_APPMODULE(OdThreadPoolModuleName, OdRxThreadPoolImpl)
 #if defined(OD_HAS_OPENGL)
 ODRX_DEFINE_STATIC_APPMODULE(OdWinOpenGLModuleName, WinOpenGLModule)
 #endif
@@ -123,29 +130,91 @@ map<string, Va3cContainer::Va3cObject*>						g_layerObjects;
 map<string, Va3cContainer::Va3cMaterial*>					g_existMaterials;
 map<string, Va3cContainer::Va3cMaterial*>					g_existPmiMaterials;
 #pragma region simple entities maps
-map<string, map<string, list<OdDbBlockBeginPtr>>>			g_blockBeginMap;
-map<string, map<string, list<OdDbBlockEndPtr>>>				g_blockEndMap;
-map<string, map<string, list<OdDbArcPtr>>>					g_arcMap;
-map<string, map<string, list<OdDbCirclePtr>>>				g_circleMap;
-map<string, map<string, list<OdDbEllipsePtr>>>				g_ellipseMap;
-map<string, map<string, list<OdDbLinePtr>>>					g_lineMap;
-map<string, map<string, list<OdDbRayPtr>>>					g_rayMap;
-map<string, map<string, list<OdDbSplinePtr>>>				g_splineMap;
-map<string, map<string, list<OdDbXlinePtr>>>				g_xlineMap;
-map<string, map<string, list<OdDbLightPtr>>>				g_lightMap;
-map<string, map<string, list<OdDbPointPtr>>>				g_pointMap;
-map<string, map<string, list<OdDbSolidPtr>>>				g_solidMap;
-map<string, map<string, list<OdDbTextPtr>>>					g_textMap;
-map<string, map<string, list<OdDbTracePtr>>>				g_traceMap;
-map<string, map<string, list<OdDbAttributeDefinitionPtr>>>	g_attributeDefinitionMap;
-map<string, map<string, list<OdDbAttributePtr>>>			g_attributeMap;
-map<string, map<string, list<OdDbFacePtr>>>					g_faceMap;
-map<string, map<string, list<OdDbShapePtr>>>				g_shapeMap;
-map<string, map<string, list<OdDbSequenceEndPtr>>>			g_sequenceEndMap;
-map<string, map<string, list<OdDb3dPolylineVertexPtr>>>		g_3dPolylineVertexMap;
-map<string, map<string, list<OdDb2dVertexPtr>>>				g_2dVertexMap;
-map<string, map<string, list<OdDbPolyFaceMeshVertexPtr>>>	g_polyFaceMeshVertexMap;
-map<string, map<string, list<OdDbPolygonMeshVertexPtr>>>	g_polygonMeshVertexMap;
+//polylines sampled from curve entities, stored back to back
+struct CurveSamples
+{
+	vector<float> points;			//x, y, z of every sample point
+	vector<unsigned int> ends;		//one past the last point of each polyline
+	vector<bool> closed;
+
+	void append(CurveSamples& other);
+};
+
+struct SolidRecord
+{
+	float points[8][3];				//the 4 corners, then the 4 corners raised by the thickness
+	bool bHasThickness;
+};
+
+struct TextRecord
+{
+	OdString text;
+	OdString fontName;
+	bool bBold;
+	bool bItalic;
+	double size;
+	OdGePoint3d position;
+	OdGeVector3d normal;
+	double rotation;
+};
+
+//line vertices which are equal after the float conversion share one slot when welding
+struct VertexKey
+{
+	float xyz[3];
+
+	bool operator==(const VertexKey& other) const
+	{
+		return xyz[0] == other.xyz[0] && xyz[1] == other.xyz[1] && xyz[2] == other.xyz[2];
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const
+	{
+		hash<float> hasher;
+		size_t h = hasher(key.xyz[0]);
+		h = h * 31 + hasher(key.xyz[1]);
+		return h * 31 + hasher(key.xyz[2]);
+	}
+};
+
+typedef unordered_map<VertexKey, int, VertexKeyHash> WeldedVertexMap;
+
+//when welding, the curves of all entity types on one layer and material share a single line geometry
+struct WeldedLines
+{
+	Va3cContainer::Va3cGeometry*	pGeometry;
+	WeldedVertexMap					vertices;
+
+	WeldedLines() : pGeometry(nullptr) {}
+};
+
+//only the geometry which is exported is kept, the entities are released right after import
+struct EntityBuckets
+{
+	map<string, map<string, CurveSamples>>			arcMap;
+	map<string, map<string, CurveSamples>>			circleMap;
+	map<string, map<string, CurveSamples>>			ellipseMap;
+	map<string, map<string, CurveSamples>>			lineMap;
+	map<string, map<string, CurveSamples>>			splineMap;
+	map<string, map<string, vector<float>>>			pointMap;
+	map<string, map<string, vector<SolidRecord>>>	solidMap;
+	map<string, map<string, vector<TextRecord>>>	textMap;
+
+	//append the entities of other to the tail of each bucket, other is left empty
+	void merge(EntityBuckets& other);
+	void clear();
+};
+
+const int													SLICES_PER_THREAD = 4;
+const unsigned int											MIN_ENTITIES_PER_SLICE = 256;
+EntityBuckets												g_entities;
+OdMutex														g_materialMutex;
+unordered_map<OdUInt64, string>								g_materialIndex;
+bool														g_bWeldVertices = false;
+map<pair<string, string>, WeldedLines>						g_weldedLines;
 #pragma endregion
 
 #pragma region 
@@ -158,12 +227,17 @@ string toString(const wstring& wstr);
 string NewGuid();
 bool isSimpleEntity(OdDbEntityPtr& pEntity);
 int getGeometryType(OdDbEntityPtr& pEntity);
-bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, string parentLayerName = "");
+void importEntities(OdDbDatabase* pDb, const OdDbObjectIdArray& entityIds);
+bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, EntityBuckets& buckets, string parentLayerName = "");
 bool isEntityVisible(OdDbEntityPtr& pEntity);
 bool isEntityOutOfRange(OdDbEntityPtr& pEntity);
-bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockReferencePtr& pParentBlockReference, string lineWidth = "1");
-bool isMaterialExsited(int type, const string& color, const string& alpha, const string& lineWidth, string& guid);
-void insert2CorrespondingMap(string layerName, string materialUuid, OdDbEntityPtr& pEntity);
+bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockReferencePtr& pParentBlockReference, int lineWidth = 1);
+OdUInt64 materialKey(int type, int color, OdUInt8 alpha, int lineWidth);
+bool isMaterialExsited(OdUInt64 key, string& guid);
+void insert2CorrespondingMap(EntityBuckets& buckets, string layerName, string materialUuid, OdDbEntityPtr& pEntity);
+bool sampleCurve(OdDbCurvePtr pCurve, CurveSamples& curves);
+void recordSolid(OdDbSolidPtr pSolid, vector<SolidRecord>& solids);
+bool recordText(OdDbTextPtr pText, vector<TextRecord>& texts);
 void release();
 
 Va3cContainer::Va3cObject* newVa3cObject(OdString name, string type);
@@ -174,10 +248,12 @@ bool exportAcDbArc();
 bool exportAcDbCircle();
 bool exportAcDbEllipse();
 bool exportAcDbSpline();
-bool exportOdGeCurve(OdGeCurve3d* pOdcGeCurve, Va3cContainer::Va3cGeometry* pGeometry);
+void exportCurveSamples(const string& layerName, const string& materialId, OdString typeName, const CurveSamples& curves);
+bool exportOdGeCurve(const CurveSamples& curves, Va3cContainer::Va3cGeometry* pGeometry, WeldedVertexMap* pWeldedVertices);
+int addLineVertex(const float* point, Va3cContainer::Va3cGeometryData& data, WeldedVertexMap* pWeldedVertices);
 bool exportAcDbSolid();
 bool exportAcDbText();
-bool exportText(OdDbTextPtr& text, Va3cContainer::Va3cObject* pObject, Va3cContainer::Va3cTextGeometry* pGeometry);
+bool exportText(const TextRecord& text, Va3cContainer::Va3cObject* pObject, Va3cContainer::Va3cTextGeometry* pGeometry);
 
 #pragma endregion
 
@@ -204,6 +280,9 @@ int main(int argc, char* argv[])
 
 		cout << "Developed using " << (const char*)svcs.product() << ", " << (const char*)svcs.versionString() << endl;
 
+		//optional third argument: -weld merges coincident line vertices of the same layer and material
+		g_bWeldVertices = argc > 3 && toString(argv[3]) == "-weld";
+
 		try
 		{
 			OdDbDatabasePtr pDb = svcs.readFile(argv[1]);
@@ -230,14 +309,18 @@ int main(int argc, char* argv[])
 				it->step();
 			}
 
-			OdDbBlockTableRecordPtr pLayoutBlocks = pDb->getActiveLayoutBTRId().safeOpenObject(OdDb::kForWrite);
+			OdDbObjectIdArray entityIds;
+			OdDbBlockTableRecordPtr pLayoutBlocks = pDb->getActiveLayoutBTRId().safeOpenObject();
 			OdDbObjectIteratorPtr itor = pLayoutBlocks->newIterator();
 			itor->start();
 			while (!itor->done())
 			{
-				importEntity(itor->entity(), false);
+				entityIds.push_back(itor->objectId());
 				itor->step();
 			}
+			itor.release();
+			pLayoutBlocks.release();
+			importEntities(pDb, entityIds);
 
 			for (auto it = g_existMaterials.begin(); it != g_existMaterials.end(); ++it)
 				g_pContainer->materials.push_back(it->second);
@@ -251,7 +334,7 @@ int main(int argc, char* argv[])
 			exportAcDbSolid();
 			exportAcDbText();
 
-			if (!NDSWeb3DModelWriter::WriteWeb3DModelFilesVersion6BufferChunks(*g_pContainer, toString(argv[2]), "model.js", "geom.bin", 2))
+			if (!NDSWeb3DModelWriter::WriteWeb3DModelFilesVersion6BufferChunks(*g_pContainer, toString(argv[2]), "model.js", "geom.bin", 2, 1, !g_bWeldVertices))
 				cout << "ʧܣ" << endl;
 
 			release();
@@ -419,7 +502,91 @@ int getGeometryType(OdDbEntityPtr& pEntity)
 	return -1;
 }
 
-bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, string layerName/* = ""*/)
+/************************************************************************/
+/* Imports a contiguous slice of the layout entities into its own       */
+/* buckets, so that merging the slices in order reproduces the serial   */
+/* import order                                                         */
+/************************************************************************/
+class EntityImporter
+{
+public:
+	EntityImporter(const OdDbObjectIdArray& entityIds, int nSlices)
+		: m_entityIds(entityIds)
+		, m_buckets(nSlices)
+	{
+	}
+
+	void operator()(OdUInt32 nSlice, OdUInt32 /*nThread*/)
+	{
+		OdUInt64 nIds = m_entityIds.size(), nSlices = m_buckets.size();
+		unsigned int begin = (unsigned int)(nIds * nSlice / nSlices);
+		unsigned int end = (unsigned int)(nIds * (nSlice + 1) / nSlices);
+		for (unsigned int i = begin; i < end; ++i)
+		{
+			OdDbEntityPtr pEntity = m_entityIds[i].safeOpenObject();
+			importEntity(pEntity, false, m_buckets[nSlice]);
+		}
+	}
+
+	void merge(EntityBuckets& buckets)
+	{
+		for (size_t i = 0; i < m_buckets.size(); ++i)
+			buckets.merge(m_buckets[i]);
+	}
+
+private:
+	const OdDbObjectIdArray& m_entityIds;
+	vector<EntityBuckets> m_buckets;
+};
+
+/************************************************************************/
+/* Switches the database to multithreaded rendering and restores the    */
+/* previous mode on scope exit, also if the queue throws                */
+/************************************************************************/
+class MtRenderGuard
+{
+public:
+	MtRenderGuard(OdDbDatabase* pDb) : m_pDb(pDb), m_prevMode(pDb->multiThreadedMode())
+	{
+		m_pDb->setMultiThreadedMode(OdDb::kMTRendering);
+	}
+	~MtRenderGuard()
+	{
+		m_pDb->setMultiThreadedMode(m_prevMode);
+	}
+
+private:
+	OdDbDatabase* m_pDb;
+	OdDb::MultiThreadedMode m_prevMode;
+};
+
+void importEntities(OdDbDatabase* pDb, const OdDbObjectIdArray& entityIds)
+{
+	OdRxThreadPoolServicePtr pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName);
+	int nThreads = pThreadPool.isNull() ? 1 : pThreadPool->numCPUs();
+	if (nThreads < 2 || entityIds.size() < MIN_ENTITIES_PER_SLICE * 2)
+	{
+		for (unsigned int i = 0; i < entityIds.size(); ++i)
+		{
+			OdDbEntityPtr pEntity = entityIds[i].safeOpenObject();
+			importEntity(pEntity, false, g_entities);
+		}
+		return;
+	}
+
+	//more slices than threads keeps the pool busy when entity cost is uneven
+	int nSlices = min<int>(nThreads * SLICES_PER_THREAD, entityIds.size() / MIN_ENTITIES_PER_SLICE);
+	EntityImporter importer(entityIds, nSlices);
+
+	{
+		MtRenderGuard mtGuard(pDb);
+		odrxThreadPoolLoop(pThreadPool.get(), (OdUInt32)nThreads, (OdUInt32)nSlices, importer, ThreadsCounter::kMtRegenAttributes);
+	}
+
+	importer.merge(g_entities);
+}
+
+bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, EntityBuckets& buckets, string layerName/* = ""*/)
 {
 	if (!isEntityVisible(pEntity))
 		return false;
@@ -438,7 +605,7 @@ bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, string layerName/* = ""
 		string materialId;
 		if (!exportMaterial(materialId, getGeometryType(pEntity), pEntity, OdDbBlockReferencePtr()))
 			return false;
-		insert2CorrespondingMap(layerName, materialId, pEntity);
+		insert2CorrespondingMap(buckets, layerName, materialId, pEntity);
 	}
 	else
 	{
@@ -449,9 +616,11 @@ bool importEntity(OdDbEntityPtr& pEntity, bool bExpoded, string layerName/* = ""
 		for (int i = 0; i < entitySet.size(); ++i)
 		{
 			OdDbEntityPtr pExplodedEntity = (OdDbEntityPtr)entitySet[i];
-			importEntity(pExplodedEntity, true, layerName);
+			importEntity(pExplodedEntity, true, buckets, layerName);
 		}
 	}
+
+	return true;
 }
 
 bool isEntityVisible(OdDbEntityPtr& pEntity)
@@ -499,9 +668,15 @@ bool isEntityOutOfRange(OdDbEntityPtr& pEntity)
 	return false;
 }
 
-bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockReferencePtr& pParentBlockReference, string lineWidth/* = "1"*/)
+bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockReferencePtr& pParentBlockReference, int lineWidth/* = 1*/)
 {
-	string strColor;
+	//entities without a geometry category are never exported and need no material
+	if (type < 0)
+	{
+		uuid.clear();
+		return true;
+	}
+
 	OdCmColor odCmColor = pEntity->color();
 	OdUInt8 r = odCmColor.red(), g = odCmColor.green(), b = odCmColor.blue();
 
@@ -535,9 +710,10 @@ bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockRef
 		b = odCmColor.blue();
 	}
 	int dColor = r << 16 | g << 8 | b;
-	strColor = toString(dColor);
+	OdUInt64 key = materialKey(type, dColor, 255, lineWidth);
 
-	if (!isMaterialExsited(type, strColor, "1", lineWidth, uuid))
+	OdMutexAutoLock lock(g_materialMutex);
+	if (!isMaterialExsited(key, uuid))
 	{
 		Va3cContainer::Va3cMaterial* pMaterial = new Va3cContainer::Va3cMaterial();
 		pMaterial->uuid = NewGuid();
@@ -549,7 +725,7 @@ bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockRef
 		else if (type == 1)
 		{
 			//test
-			//pMaterial->linewidth = lineWidth;
+			//pMaterial->linewidth = toString(lineWidth);
 			pMaterial->linewidth = "1";
 			pMaterial->type = STR_LINEBASIC_MATERIAL;
 		}
@@ -561,111 +737,129 @@ bool exportMaterial(string& uuid, int type, OdDbEntityPtr& pEntity, OdDbBlockRef
 		{
 			pMaterial->type = "MeshBasicMaterial";
 		}
-		pMaterial->color = strColor;
+		pMaterial->color = toString(dColor);
 		pMaterial->opacity = "1";
 		if (type == 3)
 			g_existPmiMaterials.insert(make_pair(pMaterial->uuid, pMaterial));
 		else
 			g_existMaterials.insert(make_pair(pMaterial->uuid, pMaterial));
+		g_materialIndex.insert(make_pair(key, pMaterial->uuid));
 	}
 
 	return true;
 }
 
-bool isMaterialExsited(int type, const string& color, const string& alpha, const string& lineWidth, string& guid)
+//geometry category, line width, alpha and rgb packed into one key, so that
+//equal materials hash to the same slot without building any string
+OdUInt64 materialKey(int type, int color, OdUInt8 alpha, int lineWidth)
 {
-	if (type == 3)
-	{
-		for (auto itor = g_existPmiMaterials.begin(); itor != g_existPmiMaterials.end(); ++itor)
-		{
-			Va3cContainer::Va3cMaterial* pMaterial = itor->second;
-
-			if (pMaterial->type.compare("MeshBasicMaterial") != 0)
-				continue;
-
-			if (pMaterial != nullptr && pMaterial->color.compare(color) == 0 && pMaterial->opacity.compare(alpha) == 0)
-			{
-				guid = itor->first;
-				return true;
-			}
-		}
-	}
-	else
-	{
-		for (auto itor = g_existMaterials.begin(); itor != g_existMaterials.end(); ++itor)
-		{
-			Va3cContainer::Va3cMaterial* pMaterial = itor->second;
-
-			if (type == 0 && pMaterial->type.compare("MeshBasicMaterial") != 0)
-				continue;
-			else if (type == 1 && pMaterial->type.compare(STR_LINEBASIC_MATERIAL) != 0)
-				continue;
-			else if (type == 2 && pMaterial->type.compare(STR_POINT_MATERIAL) != 0)
-				continue;
-
-			if (pMaterial != nullptr && pMaterial->color.compare(color) == 0 && pMaterial->opacity.compare(alpha) == 0)
-			{
-				if (type == eGeometryCategory::Line && lineWidth.compare(pMaterial->linewidth) != 0)
-					return false;
+	return (OdUInt64)(type & 0xFF) << 56
+		| (OdUInt64)(lineWidth & 0xFFFF) << 40
+		| (OdUInt64)alpha << 32
+		| (OdUInt32)(color & 0xFFFFFF);
+}
 
-				guid = itor->first;
-				return true;
-			}
-		}
-	}
-	
+bool isMaterialExsited(OdUInt64 key, string& guid)
+{
+	auto itor = g_materialIndex.find(key);
+	if (itor == g_materialIndex.end())
+		return false;
 
-	return false;
+	guid = itor->second;
+	return true;
 }
 
-void insert2CorrespondingMap(string layerName, string materialUuid, OdDbEntityPtr& pEntity)
+void insert2CorrespondingMap(EntityBuckets& buckets, string layerName, string materialUuid, OdDbEntityPtr& pEntity)
 {
-	if (pEntity->isKindOf(OdDbBlockBegin::desc()))
-		g_blockBeginMap[layerName][materialUuid].push_back((OdDbBlockBeginPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbBlockEnd::desc()))
-		g_blockEndMap[layerName][materialUuid].push_back((OdDbBlockEndPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbArc::desc()))
-		g_arcMap[layerName][materialUuid].push_back((OdDbArcPtr)pEntity->clone());
+	if (pEntity->isKindOf(OdDbArc::desc()))
+		sampleCurve(pEntity, buckets.arcMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbCircle::desc()))
-		g_circleMap[layerName][materialUuid].push_back((OdDbCirclePtr)pEntity->clone());
+		sampleCurve(pEntity, buckets.circleMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbEllipse::desc()))
-		g_ellipseMap[layerName][materialUuid].push_back((OdDbEllipsePtr)pEntity->clone());
+		sampleCurve(pEntity, buckets.ellipseMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbLine::desc()))
-		g_lineMap[layerName][materialUuid].push_back((OdDbLinePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbRay::desc()))
-		g_rayMap[layerName][materialUuid].push_back((OdDbRayPtr)pEntity->clone());
+		sampleCurve(pEntity, buckets.lineMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbSpline::desc()))
-		g_splineMap[layerName][materialUuid].push_back((OdDbSplinePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbXline::desc()))
-		g_xlineMap[layerName][materialUuid].push_back((OdDbXlinePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbLight::desc()))
-		g_lightMap[layerName][materialUuid].push_back((OdDbLightPtr)pEntity->clone());
+		sampleCurve(pEntity, buckets.splineMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbPoint::desc()))
-		g_pointMap[layerName][materialUuid].push_back((OdDbPointPtr)pEntity->clone());
+	{
+		OdGePoint3d position = ((OdDbPointPtr)pEntity)->position();
+		vector<float>& points = buckets.pointMap[layerName][materialUuid];
+		points.push_back((float)position.x);
+		points.push_back((float)position.y);
+		points.push_back((float)position.z);
+	}
 	else if (pEntity->isKindOf(OdDbSolid::desc()))
-		g_solidMap[layerName][materialUuid].push_back((OdDbSolidPtr)pEntity->clone());
+		recordSolid(pEntity, buckets.solidMap[layerName][materialUuid]);
 	else if (pEntity->isKindOf(OdDbText::desc()))
-		g_textMap[layerName][materialUuid].push_back((OdDbTextPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbTrace::desc()))
-		g_traceMap[layerName][materialUuid].push_back((OdDbTracePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbAttributeDefinition::desc()))
-		g_attributeDefinitionMap[layerName][materialUuid].push_back((OdDbAttributeDefinitionPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbAttribute::desc()))
-		g_attributeMap[layerName][materialUuid].push_back((OdDbAttributePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbFace::desc()))
-		g_faceMap[layerName][materialUuid].push_back((OdDbFacePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbShape::desc()))
-		g_shapeMap[layerName][materialUuid].push_back((OdDbShapePtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbSequenceEnd::desc()))
-		g_sequenceEndMap[layerName][materialUuid].push_back((OdDbSequenceEndPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDb3dPolylineVertex::desc()))
-		g_3dPolylineVertexMap[layerName][materialUuid].push_back((OdDb3dPolylineVertexPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDb2dVertex::desc()))
-		g_2dVertexMap[layerName][materialUuid].push_back((OdDb2dVertexPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbPolyFaceMeshVertex::desc()))
-		g_polyFaceMeshVertexMap[layerName][materialUuid].push_back((OdDbPolyFaceMeshVertexPtr)pEntity->clone());
-	else if (pEntity->isKindOf(OdDbPolygonMeshVertex::desc()))
-		g_polygonMeshVertexMap[layerName][materialUuid].push_back((OdDbPolygonMeshVertexPtr)pEntity->clone());
+		recordText(pEntity, buckets.textMap[layerName][materialUuid]);
+	//the other simple entities have no exporter yet, nothing is kept for them
+}
+
+bool sampleCurve(OdDbCurvePtr pCurve, CurveSamples& curves)
+{
+	OdGeCurve3d* pOdcGeCurve = nullptr;
+	pCurve->getOdGeCurve(pOdcGeCurve);
+	if (!pOdcGeCurve)
+		return false;
+
+	OdGePoint3dArray points;
+	pOdcGeCurve->getSamplePoints(nullptr, 0, points);
+	bool bClosed = pOdcGeCurve->isClosed();
+	delete pOdcGeCurve;
+	if (points.size() < 2)
+		return false;
+
+	for (unsigned int i = 0; i < points.size(); ++i)
+	{
+		curves.points.push_back((float)points[i].x);
+		curves.points.push_back((float)points[i].y);
+		curves.points.push_back((float)points[i].z);
+	}
+	curves.ends.push_back(curves.points.size() / 3);
+	curves.closed.push_back(bClosed);
+	return true;
+}
+
+void recordSolid(OdDbSolidPtr pSolid, vector<SolidRecord>& solids)
+{
+	SolidRecord solid;
+	OdGePoint3d points[8];
+	for (int i = 0; i < 4; ++i)
+		pSolid->getPointAt(i, points[i]);
+
+	solid.bHasThickness = pSolid->thickness() > 1e-6;
+	if (solid.bHasThickness)
+	{
+		for (int i = 0; i < 4; ++i)
+			points[i + 4] = points[i] + pSolid->thickness() * pSolid->normal();
+	}
+
+	for (int i = 0; i < 8; ++i)
+	{
+		solid.points[i][0] = (float)points[i].x;
+		solid.points[i][1] = (float)points[i].y;
+		solid.points[i][2] = (float)points[i].z;
+	}
+	solids.push_back(solid);
+}
+
+bool recordText(OdDbTextPtr pText, vector<TextRecord>& texts)
+{
+	OdDbTextStyleTableRecordPtr font = pText->textStyle().openObject(OdDb::kForRead);
+	if (font.isNull())
+		return false;
+
+	TextRecord text;
+	int charset, pitchAndFamily;
+	font->font(text.fontName, text.bBold, text.bItalic, charset, pitchAndFamily);
+	text.text = pText->textString();
+	text.size = pText->widthFactor() * pText->height();
+	text.position = pText->position();
+	text.normal = pText->normal();
+	text.rotation = pText->rotation();
+	texts.push_back(text);
+	return true;
 }
 
 Va3cContainer::Va3cObject* newVa3cObject(OdString name, string type)
@@ -691,7 +885,7 @@ bool exportAcDbPoint()
 {
 	try
 	{
-		for (auto it = g_pointMap.begin(); it != g_pointMap.end(); ++it)
+		for (auto it = g_entities.pointMap.begin(); it != g_entities.pointMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
@@ -699,21 +893,14 @@ bool exportAcDbPoint()
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
 					string materialId = itor->first;
-					list<OdDbPointPtr>& points = itor->second;
+					const vector<float>& points = itor->second;
 
 					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbPoint::desc()->name(), STR_LINE_PIECES);
 					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Point, pObject);
 					pObject->material = materialId;
 
-					for (auto it = points.begin(); it != points.end(); ++it)
-					{
-						OdDbPointPtr& point = *it;
-						OdGePoint3d position = point->position();
-						pGeometry->data.vertices.push_back(position.x);
-						pGeometry->data.vertices.push_back(position.y);
-						pGeometry->data.vertices.push_back(position.z);
-						pGeometry->data.points += 1;
-					}
+					pGeometry->data.vertices.insert(pGeometry->data.vertices.end(), points.begin(), points.end());
+					pGeometry->data.points += points.size() / 3;
 
 					g_pContainer->object.children.push_back(pObject);
 				}
@@ -732,31 +919,14 @@ bool exportAcDbLine()
 {
 	try
 	{
-		for (auto it = g_lineMap.begin(); it != g_lineMap.end(); ++it)
+		for (auto it = g_entities.lineMap.begin(); it != g_entities.lineMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
 			{
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
-					string materialId = itor->first;
-					list<OdDbLinePtr>& lines = itor->second;
-
-					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbLine::desc()->name(), STR_LINE_PIECES);
-					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
-					pObject->material = materialId;
-
-					for (auto it = lines.begin(); it != lines.end(); ++it)
-					{
-						OdDbLinePtr& line = *it;
-						OdGeCurve3d* pOdcGeCurve;
-						line->getOdGeCurve(pOdcGeCurve);
-						if (!pOdcGeCurve)
-							continue;
-						exportOdGeCurve(pOdcGeCurve, pGeometry);
-					}
-
-					g_layerObjects[layerName]->children.push_back(pObject);
+					exportCurveSamples(layerName, itor->first, OdDbLine::desc()->name(), itor->second);
 				}
 			}
 		}
@@ -773,31 +943,14 @@ bool exportAcDbArc()
 {
 	try
 	{
-		for (auto it = g_arcMap.begin(); it != g_arcMap.end(); ++it)
+		for (auto it = g_entities.arcMap.begin(); it != g_entities.arcMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
 			{
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
-					string materialId = itor->first;
-					list<OdDbArcPtr>& arcs = itor->second;
-
-					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbArc::desc()->name(), STR_LINE_PIECES);
-					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
-					pObject->material = materialId;
-
-					for (auto it = arcs.begin(); it != arcs.end(); ++it)
-					{
-						OdDbArcPtr& arc = *it;
-						OdGeCurve3d* pOdcGeCurve;
-						arc->getOdGeCurve(pOdcGeCurve);
-						if (!pOdcGeCurve)
-							continue;
-						exportOdGeCurve(pOdcGeCurve, pGeometry);
-					}
-
-					g_layerObjects[layerName]->children.push_back(pObject);
+					exportCurveSamples(layerName, itor->first, OdDbArc::desc()->name(), itor->second);
 				}
 			}
 		}
@@ -814,31 +967,14 @@ bool exportAcDbCircle()
 {
 	try
 	{
-		for (auto it = g_circleMap.begin(); it != g_circleMap.end(); ++it)
+		for (auto it = g_entities.circleMap.begin(); it != g_entities.circleMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
 			{
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
-					string materialId = itor->first;
-					list<OdDbCirclePtr>& circles = itor->second;
-
-					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbCircle::desc()->name(), STR_LINE_PIECES);
-					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
-					pObject->material = materialId;
-
-					for (auto it = circles.begin(); it != circles.end(); ++it)
-					{
-						OdDbCirclePtr& circle = *it;
-						OdGeCurve3d* pOdcGeCurve;
-						circle->getOdGeCurve(pOdcGeCurve);
-						if (!pOdcGeCurve)
-							continue;
-						exportOdGeCurve(pOdcGeCurve, pGeometry);
-					}
-
-					g_layerObjects[layerName]->children.push_back(pObject);
+					exportCurveSamples(layerName, itor->first, OdDbCircle::desc()->name(), itor->second);
 				}
 			}
 		}
@@ -855,31 +991,14 @@ bool exportAcDbEllipse()
 {
 	try
 	{
-		for (auto it = g_ellipseMap.begin(); it != g_ellipseMap.end(); ++it)
+		for (auto it = g_entities.ellipseMap.begin(); it != g_entities.ellipseMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
 			{
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
-					string materialId = itor->first;
-					list<OdDbEllipsePtr>& ellipses = itor->second;
-
-					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbEllipse::desc()->name(), STR_LINE_PIECES);
-					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
-					pObject->material = materialId;
-
-					for (auto it = ellipses.begin(); it != ellipses.end(); ++it)
-					{
-						OdDbEllipsePtr& ellipse = *it;
-						OdGeCurve3d* pOdcGeCurve;
-						ellipse->getOdGeCurve(pOdcGeCurve);
-						if (!pOdcGeCurve)
-							continue;
-						exportOdGeCurve(pOdcGeCurve, pGeometry);
-					}
-
-					g_layerObjects[layerName]->children.push_back(pObject);
+					exportCurveSamples(layerName, itor->first, OdDbEllipse::desc()->name(), itor->second);
 				}
 			}
 		}
@@ -896,31 +1015,14 @@ bool exportAcDbSpline()
 {
 	try
 	{
-		for (auto it = g_splineMap.begin(); it != g_splineMap.end(); ++it)
+		for (auto it = g_entities.splineMap.begin(); it != g_entities.splineMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
 			{
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
-					string materialId = itor->first;
-					list<OdDbSplinePtr>& splines = itor->second;
-
-					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbSpline::desc()->name(), STR_LINE_PIECES);
-					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
-					pObject->material = materialId;
-
-					for (auto it = splines.begin(); it != splines.end(); ++it)
-					{
-						OdDbSplinePtr& spline = *it;
-						OdGeCurve3d* pOdcGeCurve;
-						spline->getOdGeCurve(pOdcGeCurve);
-						if (!pOdcGeCurve)
-							continue;
-						exportOdGeCurve(pOdcGeCurve, pGeometry);
-					}
-
-					g_layerObjects[layerName]->children.push_back(pObject);
+					exportCurveSamples(layerName, itor->first, OdDbSpline::desc()->name(), itor->second);
 				}
 			}
 		}
@@ -933,53 +1035,80 @@ bool exportAcDbSpline()
 	}
 }
 
-bool exportOdGeCurve(OdGeCurve3d* pOdcGeCurve, Va3cContainer::Va3cGeometry* pGeometry)
+void exportCurveSamples(const string& layerName, const string& materialId, OdString typeName, const CurveSamples& curves)
 {
-	OdGePoint3dArray points;
-	pOdcGeCurve->getSamplePoints(nullptr, 0, points);
-	int segmentCount = points.size() - 1;
-	if (segmentCount < 1)
-		return false;
-	for (int i = 0; i < segmentCount; ++i)
+	WeldedLines* pWelded = nullptr;
+	if (g_bWeldVertices)
 	{
-		OdGePoint3d startPoint = points[i];
-		OdGePoint3d endPoint = points[i + 1];
-		pGeometry->data.vertices.push_back((float)startPoint.x);
-		pGeometry->data.vertices.push_back((float)startPoint.y);
-		pGeometry->data.vertices.push_back((float)startPoint.z);
-		pGeometry->data.vertices.push_back((float)endPoint.x);
-		pGeometry->data.vertices.push_back((float)endPoint.y);
-		pGeometry->data.vertices.push_back((float)endPoint.z);
-		pGeometry->data.indices.push_back(pGeometry->data.points);
-		pGeometry->data.indices.push_back(pGeometry->data.points + 1);
-		pGeometry->data.points += 2;
-		pGeometry->data.triangles += 1;
+		pWelded = &g_weldedLines[make_pair(layerName, materialId)];
+		if (pWelded->pGeometry)
+		{
+			exportOdGeCurve(curves, pWelded->pGeometry, &pWelded->vertices);
+			return;
+		}
 	}
 
-	if (pOdcGeCurve->isClosed())
+	Va3cContainer::Va3cObject* pObject = newVa3cObject(typeName, STR_LINE_PIECES);
+	Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Line, pObject);
+	pObject->material = materialId;
+
+	if (pWelded)
+		pWelded->pGeometry = pGeometry;
+	exportOdGeCurve(curves, pGeometry, pWelded ? &pWelded->vertices : nullptr);
+
+	g_layerObjects[layerName]->children.push_back(pObject);
+}
+
+//every sample point is written once and the segments reference it through the index buffer
+bool exportOdGeCurve(const CurveSamples& curves, Va3cContainer::Va3cGeometry* pGeometry, WeldedVertexMap* pWeldedVertices)
+{
+	Va3cContainer::Va3cGeometryData& data = pGeometry->data;
+	vector<int> polyline;
+	unsigned int begin = 0;
+	for (size_t n = 0; n < curves.ends.size(); ++n)
 	{
-		OdGePoint3d startPoint = points[points.size() - 1];
-		OdGePoint3d endPoint = points[0];
-		pGeometry->data.vertices.push_back((float)startPoint.x);
-		pGeometry->data.vertices.push_back((float)startPoint.y);
-		pGeometry->data.vertices.push_back((float)startPoint.z);
-		pGeometry->data.vertices.push_back((float)endPoint.x);
-		pGeometry->data.vertices.push_back((float)endPoint.y);
-		pGeometry->data.vertices.push_back((float)endPoint.z);
-		pGeometry->data.indices.push_back(pGeometry->data.points);
-		pGeometry->data.indices.push_back(pGeometry->data.points + 1);
-		pGeometry->data.points += 2;
-		pGeometry->data.triangles += 1;
+		unsigned int end = curves.ends[n];
+		polyline.clear();
+		for (unsigned int i = begin; i < end; ++i)
+			polyline.push_back(addLineVertex(&curves.points[3 * i], data, pWeldedVertices));
+		//without welding the closing point gets a vertex of its own, so line indices stay ascending
+		if (curves.closed[n] && begin < end)
+			polyline.push_back(addLineVertex(&curves.points[3 * begin], data, pWeldedVertices));
+
+		for (size_t i = 0; i + 1 < polyline.size(); ++i)
+		{
+			//welding may collapse a very short segment into a single vertex
+			if (polyline[i] == polyline[i + 1])
+				continue;
+			data.indices.push_back(polyline[i]);
+			data.indices.push_back(polyline[i + 1]);
+			data.triangles += 1;
+		}
+		begin = end;
 	}
 
 	return true;
 }
 
+int addLineVertex(const float* point, Va3cContainer::Va3cGeometryData& data, WeldedVertexMap* pWeldedVertices)
+{
+	if (pWeldedVertices)
+	{
+		VertexKey key = { { point[0], point[1], point[2] } };
+		auto result = pWeldedVertices->insert(make_pair(key, data.points));
+		if (!result.second)
+			return result.first->second;
+	}
+
+	data.vertices.insert(data.vertices.end(), point, point + 3);
+	return data.points++;
+}
+
 bool exportAcDbSolid()
 {
 	try
 	{
-		for (auto it = g_solidMap.begin(); it != g_solidMap.end(); ++it)
+		for (auto it = g_entities.solidMap.begin(); it != g_entities.solidMap.end(); ++it)
 		{
 			string layerName = it->first;
 			if (g_layerObjects.find(layerName) != g_layerObjects.end())
@@ -987,7 +1116,7 @@ bool exportAcDbSolid()
 				for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 				{
 					string materialId = itor->first;
-					list<OdDbSolidPtr>& solids = itor->second;
+					const vector<SolidRecord>& solids = itor->second;
 
 					Va3cContainer::Va3cObject* pObject = newVa3cObject(OdDbSolid::desc()->name(), STR_MESH);
 					Va3cContainer::Va3cGeometry* pGeometry = newVa3cGeometry(eGeometryCategory::Triangle, pObject);
@@ -995,26 +1124,21 @@ bool exportAcDbSolid()
 
 					for (auto it = solids.begin(); it != solids.end(); ++it)
 					{
-						OdDbSolidPtr& solid = *it;
-						OdGePoint3d point1, point2, point3, point4;
-						solid->getPointAt(0, point1);
-						solid->getPointAt(1, point2);
-						solid->getPointAt(2, point3);
-						solid->getPointAt(3, point4);
+						const SolidRecord& solid = *it;
 
 						int curNbPoints = pGeometry->data.points;
-						pGeometry->data.vertices.push_back((float)point1.x);
-						pGeometry->data.vertices.push_back((float)point1.y);
-						pGeometry->data.vertices.push_back((float)point1.z);
-						pGeometry->data.vertices.push_back((float)point2.x);
-						pGeometry->data.vertices.push_back((float)point2.y);
-						pGeometry->data.vertices.push_back((float)point2.z);
-						pGeometry->data.vertices.push_back((float)point3.x);
-						pGeometry->data.vertices.push_back((float)point3.y);
-						pGeometry->data.vertices.push_back((float)point3.z);
-						pGeometry->data.vertices.push_back((float)point4.x);
-						pGeometry->data.vertices.push_back((float)point4.y);
-						pGeometry->data.vertices.push_back((float)point4.z);
+						pGeometry->data.vertices.push_back(solid.points[0][0]);
+						pGeometry->data.vertices.push_back(solid.points[0][1]);
+						pGeometry->data.vertices.push_back(solid.points[0][2]);
+						pGeometry->data.vertices.push_back(solid.points[1][0]);
+						pGeometry->data.vertices.push_back(solid.points[1][1]);
+						pGeometry->data.vertices.push_back(solid.points[1][2]);
+						pGeometry->data.vertices.push_back(solid.points[2][0]);
+						pGeometry->data.vertices.push_back(solid.points[2][1]);
+						pGeometry->data.vertices.push_back(solid.points[2][2]);
+						pGeometry->data.vertices.push_back(solid.points[3][0]);
+						pGeometry->data.vertices.push_back(solid.points[3][1]);
+						pGeometry->data.vertices.push_back(solid.points[3][2]);
 						pGeometry->data.indices.push_back(curNbPoints);
 						pGeometry->data.indices.push_back(curNbPoints + 1);
 						pGeometry->data.indices.push_back(curNbPoints + 2);
@@ -1025,24 +1149,20 @@ bool exportAcDbSolid()
 						pGeometry->data.triangles += 2;
 
 						//
-						if (solid->thickness() > 1e-6)
+						if (solid.bHasThickness)
 						{
-							OdGePoint3d point5 = point1 + solid->thickness() * solid->normal();
-							OdGePoint3d point6 = point2 + solid->thickness() * solid->normal();
-							OdGePoint3d point7 = point3 + solid->thickness() * solid->normal();
-							OdGePoint3d point8 = point4 + solid->thickness() * solid->normal();
-							pGeometry->data.vertices.push_back((float)point5.x);
-							pGeometry->data.vertices.push_back((float)point5.y);
-							pGeometry->data.vertices.push_back((float)point5.z);
-							pGeometry->data.vertices.push_back((float)point6.x);
-							pGeometry->data.vertices.push_back((float)point6.y);
-							pGeometry->data.vertices.push_back((float)point6.z);
-							pGeometry->data.vertices.push_back((float)point7.x);
-							pGeometry->data.vertices.push_back((float)point7.y);
-							pGeometry->data.vertices.push_back((float)point7.z);
-							pGeometry->data.vertices.push_back((float)point8.x);
-							pGeometry->data.vertices.push_back((float)point8.y);
-							pGeometry->data.vertices.push_back((float)point8.z);
+							pGeometry->data.vertices.push_back(solid.points[4][0]);
+							pGeometry->data.vertices.push_back(solid.points[4][1]);
+							pGeometry->data.vertices.push_back(solid.points[4][2]);
+							pGeometry->data.vertices.push_back(solid.points[5][0]);
+							pGeometry->data.vertices.push_back(solid.points[5][1]);
+							pGeometry->data.vertices.push_back(solid.points[5][2]);
+							pGeometry->data.vertices.push_back(solid.points[6][0]);
+							pGeometry->data.vertices.push_back(solid.points[6][1]);
+							pGeometry->data.vertices.push_back(solid.points[6][2]);
+							pGeometry->data.vertices.push_back(solid.points[7][0]);
+							pGeometry->data.vertices.push_back(solid.points[7][1]);
+							pGeometry->data.vertices.push_back(solid.points[7][2]);
 							pGeometry->data.indices.push_back(curNbPoints);
 							pGeometry->data.indices.push_back(curNbPoints + 2);
 							pGeometry->data.indices.push_back(curNbPoints + 4);
@@ -1095,12 +1215,12 @@ bool exportAcDbText()
 {
 	try
 	{
-		for (auto it = g_textMap.begin(); it != g_textMap.end(); ++it)
+		for (auto it = g_entities.textMap.begin(); it != g_entities.textMap.end(); ++it)
 		{
 			for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
 			{
 				string materialId = itor->first;
-				list<OdDbTextPtr>& texts = itor->second;
+				const vector<TextRecord>& texts = itor->second;
 
 				for (auto it = texts.begin(); it != texts.end(); ++it)
 				{
@@ -1112,7 +1232,7 @@ bool exportAcDbText()
 					pObject->geometry = pGeometry->uuid;
 					pObject->material = materialId;
 
-					OdDbTextPtr& text = *it;
+					const TextRecord& text = *it;
 					if (!exportText(text, pObject, pGeometry))
 						continue;
 
@@ -1130,12 +1250,12 @@ bool exportAcDbText()
 	}
 }
 
-bool exportText(OdDbTextPtr& text, Va3cContainer::Va3cObject* pObject, Va3cContainer::Va3cTextGeometry* pGeometry)
+bool exportText(const TextRecord& text, Va3cContainer::Va3cObject* pObject, Va3cContainer::Va3cTextGeometry* pGeometry)
 {
 	string textString;
-	for (int i = 0; i < text->textString().getLength(); ++i)
+	for (int i = 0; i < text.text.getLength(); ++i)
 	{
-		unsigned short c = text->textString()[i];
+		unsigned short c = text.text[i];
 		if (c >= 0x4E00 && c <= 0x9FA5)
 			pGeometry->isChina = true;
 		char buf[64] = { 0 };
@@ -1145,19 +1265,14 @@ bool exportText(OdDbTextPtr& text, Va3cContainer::Va3cObject* pObject, Va3cConta
 	if (textString.empty())
 		return false;
 	pGeometry->text = textString;
-	OdDbTextStyleTableRecordPtr font = text->textStyle().safeOpenObject(OdDb::kForRead);
-	OdString fontName;
-	bool bBold, bItalic;
-	int charset, pitchAndFamily;
-	font->font(fontName, bBold, bItalic, charset, pitchAndFamily);
-	pGeometry->textFont.name = toUtf8(fontName);
-	pGeometry->textFont.size = text->widthFactor() * text->height();
-	pGeometry->textFont.style = bItalic ? "italic" : "normal";
-	pGeometry->textFont.weight = bBold ? "bold" : "normal";
-
-	OdGePoint3d position = text->position();
-	OdGeVector3d normal = text->normal();
-	OdGeVector3d direction = OdGeVector3d(cos(text->rotation()), sin(text->rotation()), 0);
+	pGeometry->textFont.name = toUtf8(text.fontName);
+	pGeometry->textFont.size = text.size;
+	pGeometry->textFont.style = text.bItalic ? "italic" : "normal";
+	pGeometry->textFont.weight = text.bBold ? "bold" : "normal";
+
+	OdGePoint3d position = text.position;
+	OdGeVector3d normal = text.normal;
+	OdGeVector3d direction = OdGeVector3d(cos(text.rotation), sin(text.rotation), 0);
 	pObject->bHasMatrix = true;
 	float u[3] = { direction.x, direction.y, direction.z };
 	float n[3] = { normal.x, normal.y, normal.z };
@@ -1189,29 +1304,71 @@ bool exportText(OdDbTextPtr& text, Va3cContainer::Va3cObject* pObject, Va3cConta
 	return true;
 }
 
+void CurveSamples::append(CurveSamples& other)
+{
+	unsigned int base = points.size() / 3;
+	points.insert(points.end(), other.points.begin(), other.points.end());
+	for (size_t i = 0; i < other.ends.size(); ++i)
+		ends.push_back(base + other.ends[i]);
+	closed.insert(closed.end(), other.closed.begin(), other.closed.end());
+	other = CurveSamples();
+}
+
+void appendRecords(CurveSamples& dest, CurveSamples& src)
+{
+	if (dest.ends.empty())
+		swap(dest, src);
+	else
+		dest.append(src);
+}
+
+template <class T>
+void appendRecords(vector<T>& dest, vector<T>& src)
+{
+	if (dest.empty())
+		dest.swap(src);
+	else
+		dest.insert(dest.end(), src.begin(), src.end());
+}
+
+template <class T>
+void mergeBucket(map<string, map<string, T>>& dest, map<string, map<string, T>>& src)
+{
+	for (auto it = src.begin(); it != src.end(); ++it)
+	{
+		for (auto itor = it->second.begin(); itor != it->second.end(); ++itor)
+			appendRecords(dest[it->first][itor->first], itor->second);
+	}
+	src.clear();
+}
+
+void EntityBuckets::merge(EntityBuckets& other)
+{
+	mergeBucket(arcMap, other.arcMap);
+	mergeBucket(circleMap, other.circleMap);
+	mergeBucket(ellipseMap, other.ellipseMap);
+	mergeBucket(lineMap, other.lineMap);
+	mergeBucket(splineMap, other.splineMap);
+	mergeBucket(pointMap, other.pointMap);
+	mergeBucket(solidMap, other.solidMap);
+	mergeBucket(textMap, other.textMap);
+}
+
+void EntityBuckets::clear()
+{
+	arcMap.clear();
+	circleMap.clear();
+	ellipseMap.clear();
+	lineMap.clear();
+	splineMap.clear();
+	pointMap.clear();
+	solidMap.clear();
+	textMap.clear();
+}
+
 void release()
 {
-	g_blockBeginMap.clear();
-	g_blockEndMap.clear();
-	g_arcMap.clear();
-	g_circleMap.clear();
-	g_ellipseMap.clear();
-	g_lineMap.clear();
-	g_rayMap.clear();
-	g_splineMap.clear();
-	g_xlineMap.clear();
-	g_lightMap.clear();
-	g_pointMap.clear();
-	g_solidMap.clear();
-	g_textMap.clear();
-	g_traceMap.clear();
-	g_attributeDefinitionMap.clear();
-	g_attributeMap.clear();
-	g_faceMap.clear();
-	g_shapeMap.clear();
-	g_sequenceEndMap.clear();
-	g_3dPolylineVertexMap.clear();
-	g_2dVertexMap.clear();
-	g_polyFaceMeshVertexMap.clear();
-	g_polygonMeshVertexMap.clear();
+	g_entities.clear();
+	g_materialIndex.clear();
+	g_weldedLines.clear();
 }
\ No newline at end of file